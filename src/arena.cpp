@@ -0,0 +1,245 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "arena.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+constexpr size_t ARENA_HUGE_PAGE = 2 << 20;
+
+std::atomic<bool> numaInterleave{false};
+
+std::string& storageDirectory() {
+    static std::string directory;
+    return directory;
+}
+
+size_t hugePageSize(const size_t bytes) {
+    return (bytes + ARENA_HUGE_PAGE - 1) & ~(ARENA_HUGE_PAGE - 1);
+}
+
+void setNumaInterleave(const bool enabled) {
+    numaInterleave.store(enabled, std::memory_order_relaxed);
+}
+
+void setStorageDirectory(const std::string &directory) {
+    storageDirectory() = directory;
+}
+
+void* allocateHeap(const size_t bytes) {
+    if (void *pointer = std::calloc(bytes, 1); pointer != nullptr) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+#ifdef _WIN32
+
+void* allocateZeroed(const size_t bytes, ArenaBacking &backing) {
+    if (bytes < ARENA_HUGE_PAGE) {
+        backing = HEAP_BACKING;
+        return allocateHeap(bytes);
+    }
+
+    if (const std::string &directory = storageDirectory(); !directory.empty()) {
+        char path[MAX_PATH];
+        if (GetTempFileNameA(directory.c_str(), "cmz", 0, path) == 0) {
+            throw std::runtime_error("Cannot create a storage file in " + directory);
+        }
+
+        // The file is deleted once the view and both handles are closed.
+        const HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                        FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            DeleteFileA(path);
+            throw std::runtime_error("Cannot create a storage file in " + directory);
+        }
+
+        const auto size = static_cast<uint64_t>(bytes);
+        const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+        void *pointer = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes) : nullptr;
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        if (pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        backing = FILE_BACKING;
+        return pointer;
+    }
+
+    // Committed pages are zeroed on first access. Large pages need a privilege regular users lack, so they are not requested.
+    void *pointer = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    backing = MEMORY_BACKING;
+    return pointer;
+}
+
+void freeZeroed(void *pointer, const size_t, const ArenaBacking backing) {
+    switch (backing) {
+        case HEAP_BACKING:
+            std::free(pointer);
+            break;
+        case MEMORY_BACKING:
+            VirtualFree(pointer, 0, MEM_RELEASE);
+            break;
+        case FILE_BACKING:
+            UnmapViewOfFile(pointer);
+            break;
+    }
+}
+
+void adviseAccess(void *, size_t, ArenaAccess) {}
+
+#else
+
+int openStorageFile(const std::string &directory) {
+#ifdef O_TMPFILE
+    if (const int descriptor = open(directory.c_str(), O_TMPFILE | O_RDWR, 0600); descriptor != -1) {
+        return descriptor;
+    }
+#endif
+    std::string path = directory + "/cmaze-XXXXXX";
+    const int descriptor = mkstemp(path.data());
+    if (descriptor != -1) {
+        unlink(path.c_str());
+    }
+    return descriptor;
+}
+
+void* allocateFile(const std::string &directory, const size_t length) {
+    const int descriptor = openStorageFile(directory);
+    if (descriptor == -1) {
+        throw std::runtime_error("Cannot create a storage file in " + directory);
+    }
+
+    // The file is sparse: unwritten pages read as zeros and take no disk space.
+    void *pointer = MAP_FAILED;
+    if (ftruncate(descriptor, static_cast<off_t>(length)) == 0) {
+        pointer = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+
+    if (pointer == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* allocateMemory(const size_t length) {
+    // One extra huge page is mapped so the block can be trimmed to start on a huge page boundary.
+    void *mapping = mmap(nullptr, length + ARENA_HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    const auto address = reinterpret_cast<uintptr_t>(mapping);
+    const uintptr_t start = (address + ARENA_HUGE_PAGE - 1) & ~(ARENA_HUGE_PAGE - 1);
+    if (start != address) {
+        munmap(mapping, start - address);
+    }
+    if (const size_t tail = address + ARENA_HUGE_PAGE - start; tail != 0) {
+        munmap(reinterpret_cast<void *>(start + length), tail);
+    }
+
+    auto *pointer = reinterpret_cast<void *>(start);
+
+#ifdef MADV_HUGEPAGE
+    madvise(pointer, length, MADV_HUGEPAGE);
+#endif
+
+    return pointer;
+}
+
+void* allocateZeroed(const size_t bytes, ArenaBacking &backing) {
+    if (bytes < ARENA_HUGE_PAGE) {
+        backing = HEAP_BACKING;
+        return allocateHeap(bytes);
+    }
+
+    const size_t length = hugePageSize(bytes);
+    void *pointer;
+    if (const std::string &directory = storageDirectory(); !directory.empty()) {
+        pointer = allocateFile(directory, length);
+        backing = FILE_BACKING;
+    } else {
+        pointer = allocateMemory(length);
+        backing = MEMORY_BACKING;
+    }
+
+#ifdef SYS_mbind
+    // MPOL_INTERLEAVE over every node: the kernel restricts the mask to the nodes this process may use.
+    if (numaInterleave.load(std::memory_order_relaxed)) {
+        constexpr int MPOL_INTERLEAVE = 3;
+        constexpr unsigned long ALL_NODES[16] = {~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL, ~0UL};
+        syscall(SYS_mbind, pointer, length, MPOL_INTERLEAVE, ALL_NODES, sizeof(ALL_NODES) * 8, 0);
+    }
+#endif
+
+    return pointer;
+}
+
+void freeZeroed(void *pointer, const size_t bytes, const ArenaBacking backing) {
+    if (backing == HEAP_BACKING) {
+        std::free(pointer);
+    } else {
+        munmap(pointer, hugePageSize(bytes));
+    }
+}
+
+void adviseAccess(void *pointer, const size_t bytes, const ArenaAccess access) {
+    if (bytes < ARENA_HUGE_PAGE) {
+        return;
+    }
+    switch (access) {
+        case NORMAL_ACCESS:
+            madvise(pointer, hugePageSize(bytes), MADV_NORMAL);
+            break;
+        case SEQUENTIAL_ACCESS:
+            madvise(pointer, hugePageSize(bytes), MADV_SEQUENTIAL);
+            break;
+        case RANDOM_ACCESS:
+            madvise(pointer, hugePageSize(bytes), MADV_RANDOM);
+            break;
+    }
+}
+
+#endif
@@ -0,0 +1,125 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+enum ArenaBacking {HEAP_BACKING, MEMORY_BACKING, FILE_BACKING};
+
+enum ArenaAccess {NORMAL_ACCESS, SEQUENTIAL_ACCESS, RANDOM_ACCESS};
+
+// Large blocks are mapped directly from the system: their pages are zeroed lazily by the kernel on first touch,
+// aligned on huge pages and, when enabled, interleaved across NUMA nodes. Small blocks use calloc.
+// When a storage directory is set, large blocks are mapped from unlinked sparse files in it instead,
+// so they can exceed physical memory: the kernel writes pages back to disk rather than to swap.
+void* allocateZeroed(size_t bytes, ArenaBacking &backing);
+
+void freeZeroed(void *pointer, size_t bytes, ArenaBacking backing);
+
+void adviseAccess(void *pointer, size_t bytes, ArenaAccess access);
+
+void setNumaInterleave(bool enabled);
+
+void setStorageDirectory(const std::string &directory);
+
+// A fixed-size array of trivial values which are all zero after each allocation, without a pass over the memory.
+template <typename T>
+class ZeroedArray {
+    static_assert(std::is_trivial_v<T>);
+
+    public:
+
+    ZeroedArray() = default;
+
+    explicit ZeroedArray(const size_t size) {
+        reset(size);
+    }
+
+    ZeroedArray(ZeroedArray &&other) noexcept :
+        _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0)), _backing(other._backing) {}
+
+    ZeroedArray& operator=(ZeroedArray &&other) noexcept {
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        std::swap(_backing, other._backing);
+        return *this;
+    }
+
+    ~ZeroedArray() {
+        release();
+    }
+
+    void reset(const size_t size) {
+        release();
+        if (size != 0) {
+            _data = static_cast<T *>(allocateZeroed(size * sizeof(T), _backing));
+            _size = size;
+        }
+    }
+
+    void advise(const ArenaAccess access) {
+        if (_data != nullptr) {
+            adviseAccess(_data, _size * sizeof(T), access);
+        }
+    }
+
+    [[nodiscard]] size_t size() const {
+        return _size;
+    }
+
+    [[nodiscard]] T* data() {
+        return _data;
+    }
+
+    [[nodiscard]] const T* data() const {
+        return _data;
+    }
+
+    T& operator[](const size_t index) {
+        return _data[index];
+    }
+
+    const T& operator[](const size_t index) const {
+        return _data[index];
+    }
+
+    private:
+
+    void release() {
+        if (_data != nullptr) {
+            freeZeroed(_data, _size * sizeof(T), _backing);
+            _data = nullptr;
+            _size = 0;
+        }
+    }
+
+    T *_data = nullptr;
+    size_t _size = 0;
+    ArenaBacking _backing = HEAP_BACKING;
+};
+
+#endif //ARENA_HPP
@@ -0,0 +1,316 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "batch.hpp"
+
+#include <QBuffer>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThreadPool>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <exception>
+#include <iostream>
+
+#include "parallel.hpp"
+#include "png_writer.hpp"
+#include "renderer.hpp"
+#include "streaming_maze.hpp"
+
+// Groups the scanlines of one maze into batches of blocks for the encoding stage.
+class BandSink : public ScanlineSink {
+    public:
+
+    BandSink(const size_t job, const size_t lineSize, const unsigned int batchSize, BoundedQueue<BatchBand> &bands) :
+        _job(job), _lineSize(lineSize), _batchSize(batchSize), _bands(bands) {}
+
+    void writeLines(const uint8_t *line, const int count) override {
+        if (_blocks.empty() || _blocks.back().lineCount() * _lineSize >= MAZE_BAND_BYTES) {
+            if (_blocks.size() == _batchSize) {
+                flush();
+            }
+            _blocks.emplace_back(_lineSize);
+        }
+        _blocks.back().writeLines(line, count);
+    }
+
+    void writeBlocks(const std::vector<ScanlineBlock> &blocks, const size_t count) override {
+        flush();
+        _bands.push({_job, {blocks.begin(), blocks.begin() + static_cast<std::ptrdiff_t>(count)}, false, false});
+    }
+
+    // A failed maze still ends its bands, so that the encoding stage drops it and moves on to the next one.
+    void finish(const bool failed = false) {
+        flush();
+        _bands.push({_job, {}, true, failed});
+    }
+
+    private:
+
+    void flush() {
+        if (!_blocks.empty()) {
+            _bands.push({_job, std::move(_blocks), false, false});
+            _blocks.clear();
+        }
+    }
+
+    size_t _job, _lineSize;
+    unsigned int _batchSize;
+    std::vector<ScanlineBlock> _blocks{};
+    BoundedQueue<BatchBand> &_bands;
+};
+
+Batch::Batch(std::vector<WorkerParameters> jobs) : _jobs(std::move(jobs)), _succeeded(_jobs.size(), false) {}
+
+bool Batch::readManifest(const QString &fileName, const int threads, std::vector<WorkerParameters> &jobs) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        std::cerr << "Cannot read manifest: " << fileName.toStdString() << std::endl;
+        return false;
+    }
+
+    QTextStream stream(&file);
+    for (int lineNumber = 1; !stream.atEnd(); lineNumber++) {
+        const QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        const QStringList fields = line.split(',');
+        bool ok = fields.size() >= 7 && fields.size() <= 10;
+
+        WorkerParameters parameters{};
+        const auto parseInt = [&](const qsizetype index, const int minimum, int &value) {
+            value = fields[index].trimmed().toInt(&ok);
+            ok = ok && value >= minimum;
+            return ok;
+        };
+
+        if (ok && parseInt(0, INT_MIN, parameters.seed) && parseInt(1, 1, parameters.width) && parseInt(2, 1, parameters.height)) {
+            parameters.errorFactor = fields[3].trimmed().toDouble(&ok);
+            ok = ok && parameters.errorFactor >= 0 && parameters.errorFactor <= 1;
+        }
+
+        if (ok && parseInt(4, 1, parameters.pathSize) && parseInt(5, 1, parameters.wallSize)) {
+            parameters.fileName = fields[6].trimmed();
+            ok = !parameters.fileName.isEmpty();
+        }
+
+        if (ok && fields.size() >= 8) {
+            ok = false;
+            for (const Engine engine : ENGINES) {
+                if (fields[7].trimmed() == engineName(engine)) {
+                    parameters.engine = engine;
+                    ok = true;
+                }
+            }
+        }
+
+        if (ok && fields.size() >= 9) {
+            ok = parseInt(8, 0, parameters.compressionLevel) && parameters.compressionLevel <= 9;
+        }
+
+        if (ok && fields.size() >= 10) {
+            ok = false;
+            for (const RandomAlgorithm algorithm : RANDOM_ALGORITHMS) {
+                if (fields[9].trimmed() == randomAlgorithmName(algorithm)) {
+                    parameters.randomAlgorithm = algorithm;
+                    ok = true;
+                }
+            }
+        }
+
+        ok = ok && canConnect(parameters.engine, parameters.randomAlgorithm, parameters.errorFactor, static_cast<uint64_t>(parameters.width) * parameters.height);
+
+        if (!ok) {
+            std::cerr << "Invalid manifest line " << lineNumber << ": " << line.toStdString() << std::endl;
+            return false;
+        }
+
+        parameters.threads = threads;
+        jobs.push_back(parameters);
+    }
+    return true;
+}
+
+bool Batch::run() {
+    std::cout << "Generating " << _jobs.size() << " mazes ..." << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(3);
+    pool.start([this] {
+        generate();
+        _mazes.close();
+    });
+    pool.start([this] {
+        render();
+        _bands.close();
+    });
+    pool.start([this] {
+        encode();
+        _chunks.close();
+    });
+    write();
+    pool.waitForDone();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t mazes = 0;
+    double cells = 0;
+    for (size_t job = 0; job < _jobs.size(); job++) {
+        if (_succeeded[job]) {
+            mazes++;
+            cells += static_cast<double>(_jobs[job].width) * _jobs[job].height;
+        }
+    }
+
+    std::cout << "Batch done. " << mazes << "/" << _jobs.size() << " mazes written in " << std::lround(seconds * 1000) << " ms ("
+        << mazes / seconds << " mazes/s, " << cells / seconds << " cells/s)" << std::endl;
+    return mazes == _jobs.size();
+}
+
+void Batch::generate() {
+    for (size_t job = 0; job < _jobs.size(); job++) {
+        const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _jobs[job];
+
+        // A maze that cannot be generated is never handed to the next stages, so it is reported as not written.
+        std::unique_ptr<Maze> maze;
+        if (engine != STREAMING) {
+            try {
+                maze = std::make_unique<Maze>(width, height);
+                maze->fill();
+                withGenerator(randomAlgorithm, seed, [&](auto &generator) {
+                    maze->connect(engine, generator, errorFactor, threads);
+                });
+            } catch (const std::exception &error) {
+                std::cout << "Generation failed: " << error.what() << ". (" << fileName.toStdString() << ")" << std::endl;
+                continue;
+            }
+        }
+        _mazes.push({job, std::move(maze)});
+    }
+}
+
+void Batch::render() {
+    BatchMaze item;
+    while (_mazes.pop(item)) {
+        const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _jobs[item.job];
+
+        const size_t lineSize = (pixelSize(width, pathSize, wallSize) + 7) / 8;
+        BandSink sink(item.job, lineSize, threadCount(threads), _bands);
+
+        try {
+            if (item.maze != nullptr) {
+                item.maze->generateImage(pathSize, wallSize, sink, threads);
+                item.maze.reset();
+            } else {
+                StreamingMaze maze(width, height);
+
+                Renderer renderer(width, pathSize, wallSize, sink);
+                renderer.renderTop();
+                withGenerator(randomAlgorithm, seed, [&](auto &generator) {
+                    maze.generate(generator, errorFactor, [&renderer](unsigned int, const uint64_t *right, const uint64_t *down) {
+                        renderer.renderRow(right, down);
+                    });
+                });
+            }
+        } catch (const std::exception &error) {
+            std::cout << "Rendering failed: " << error.what() << ". (" << fileName.toStdString() << ")" << std::endl;
+            item.maze.reset();
+            sink.finish(true);
+            continue;
+        }
+
+        sink.finish();
+    }
+}
+
+void Batch::encode() {
+    BatchBand band;
+    QBuffer buffer;
+    std::unique_ptr<PngWriter> writer;
+    bool failed = false;
+
+    while (_bands.pop(band)) {
+        const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _jobs[band.job];
+
+        try {
+            if (writer == nullptr) {
+                buffer.open(QIODevice::WriteOnly);
+                writer = std::make_unique<PngWriter>(buffer, compressionLevel, threads);
+                failed = !writer->open(pixelSize(width, pathSize, wallSize), pixelSize(height, pathSize, wallSize));
+            }
+
+            failed = failed || band.failed;
+            if (!failed) {
+                writer->writeBlocks(band.blocks, band.blocks.size());
+                if (band.last) {
+                    failed = !writer->finish();
+                }
+            }
+        } catch (const std::exception &error) {
+            std::cout << "Encoding failed: " << error.what() << ". (" << fileName.toStdString() << ")" << std::endl;
+            failed = true;
+        }
+
+        _chunks.push({band.job, buffer.data(), band.last, failed});
+        buffer.buffer().clear();
+        buffer.seek(0);
+
+        if (band.last) {
+            writer.reset();
+            buffer.close();
+        }
+    }
+}
+
+void Batch::write() {
+    BatchChunk chunk;
+    std::unique_ptr<QSaveFile> file;
+    bool failed = false;
+
+    while (_chunks.pop(chunk)) {
+        const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _jobs[chunk.job];
+
+        if (file == nullptr) {
+            file = std::make_unique<QSaveFile>(fileName);
+            failed = !file->open(QIODevice::WriteOnly);
+        }
+
+        failed = failed || chunk.failed || file->write(chunk.data) != chunk.data.size();
+
+        if (chunk.last) {
+            if (failed) {
+                file->cancelWriting();
+            } else {
+                _succeeded[chunk.job] = file->commit();
+            }
+            file.reset();
+
+            std::cout << "Write " << (_succeeded[chunk.job] ? "succeeded" : "failed") << ". (" << fileName.toStdString() << ", "
+                << width << "x" << height << ", seed:" << seed << ", engine:" << engineName(engine) << ")" << std::endl;
+        }
+    }
+}
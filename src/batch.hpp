@@ -0,0 +1,86 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <QByteArray>
+#include <QString>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "bounded_queue.hpp"
+#include "maze.hpp"
+#include "scanline.hpp"
+#include "worker.hpp"
+
+// A generated maze, or no maze when the job uses the streaming engine which generates while rendering.
+struct BatchMaze {
+    size_t job;
+    std::unique_ptr<Maze> maze;
+};
+
+struct BatchBand {
+    size_t job;
+    std::vector<ScanlineBlock> blocks;
+    bool last, failed;
+};
+
+struct BatchChunk {
+    size_t job;
+    QByteArray data;
+    bool last, failed;
+};
+
+// Generates many mazes through a pipeline of four stages: generation, rendering, encoding and writing.
+// Each stage runs on its own thread and hands its results to the next one through a bounded queue,
+// so the file of one maze is written while the following mazes are generated.
+class Batch {
+    public:
+
+    explicit Batch(std::vector<WorkerParameters> jobs);
+
+    // Reads one job per line: seed,width,height,errorFactor,pathSize,wallSize,fileName[,engine[,compressionLevel[,randomAlgorithm]]].
+    // Blank lines and lines starting with # are ignored.
+    static bool readManifest(const QString &fileName, int threads, std::vector<WorkerParameters> &jobs);
+
+    bool run();
+
+    private:
+
+    void generate();
+
+    void render();
+
+    void encode();
+
+    void write();
+
+    std::vector<WorkerParameters> _jobs;
+    std::vector<bool> _succeeded;
+
+    BoundedQueue<BatchMaze> _mazes{1};
+    BoundedQueue<BatchBand> _bands{4};
+    BoundedQueue<BatchChunk> _chunks{16};
+};
+
+#endif //BATCH_HPP
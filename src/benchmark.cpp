@@ -0,0 +1,399 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "arena.hpp"
+#include "fingerprint.hpp"
+#include "maze.hpp"
+#include "maze_analysis.hpp"
+#include "path_index.hpp"
+#include "png_writer.hpp"
+#include "renderer.hpp"
+#include "streaming_maze.hpp"
+#include "worker.hpp"
+
+// Peak resident memory of the process since it started, in bytes.
+// Every case runs in the same process, so on Linux the high-water mark is reset before each one and read from VmHWM,
+// which unlike ru_maxrss follows the reset. The heap freed by the previous case is returned to the system first.
+// Elsewhere the peak can only cover the whole process.
+void resetPeakMemory() {
+#if defined(__linux__)
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+size_t peakMemory() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#elif defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    size_t kibibytes;
+    while (status >> key) {
+        if (key == "VmHWM:" && status >> kibibytes) {
+            return kibibytes * 1024;
+        }
+        status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return 0;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+double measure(const std::function<void()> &task) {
+    const auto start = std::chrono::steady_clock::now();
+    task();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Counts the bytes of the rendered image without keeping them.
+class CountingSink : public ScanlineSink {
+    public:
+
+    explicit CountingSink(const size_t lineSize) : _lineSize(lineSize) {}
+
+    void writeLines(const uint8_t *, const int count) override {
+        _bytes += _lineSize * count;
+    }
+
+    [[nodiscard]] size_t bytes() const {
+        return _bytes;
+    }
+
+    private:
+
+    size_t _lineSize;
+    size_t _bytes = 0;
+};
+
+struct Render {
+    int pathSize, wallSize;
+};
+
+// One line per measurement. Bytes per cell is the output size for the render and png stages,
+// and the peak resident memory of the process for the other stages.
+void report(const char *stage, const char *engine, const RandomAlgorithm random, const unsigned int size, const int threads, const double errorFactor,
+            const Render &render, const double seconds, const double bytes, const uint64_t fingerprint) {
+    const double cells = static_cast<double>(size) * size;
+    std::cout << stage << "," << engine << "," << randomAlgorithmName(random) << "," << size << "x" << size << "," << threads << "," << errorFactor << ","
+        << render.pathSize << ":" << render.wallSize << "," << std::lround(seconds * 1000) << "," << std::lround(cells / seconds) << ","
+        << bytes / cells << "," << peakMemory() / (1024 * 1024) << ",";
+    if (fingerprint != 0) {
+        std::cout << std::hex << std::setw(16) << std::setfill('0') << fingerprint << std::dec << std::setfill(' ');
+    }
+    std::cout << std::endl;
+}
+
+void benchmarkImage(Maze &maze, const char *engine, const RandomAlgorithm random, const unsigned int size, const int threads, const double errorFactor,
+                    const std::vector<Render> &renders, const int compressionLevel, const QString &fileName) {
+    for (const Render &render : renders) {
+        CountingSink sink((pixelSize(size, render.pathSize, render.wallSize) + 7) / 8);
+        double seconds = measure([&] {
+            maze.generateImage(render.pathSize, render.wallSize, sink, threads);
+        });
+        report("render", engine, random, size, threads, errorFactor, render, seconds, static_cast<double>(sink.bytes()), 0);
+
+        bool written = false;
+        seconds = measure([&] {
+            PngWriter writer(fileName, compressionLevel, threads);
+            if (writer.open(pixelSize(size, render.pathSize, render.wallSize), pixelSize(size, render.pathSize, render.wallSize))) {
+                maze.generateImage(render.pathSize, render.wallSize, writer, threads);
+                written = writer.finish();
+            }
+        });
+        if (written) {
+            report("png", engine, random, size, threads, errorFactor, render, seconds, static_cast<double>(QFileInfo(fileName).size()), 0);
+            QFile::remove(fileName);
+        } else {
+            std::cerr << "Cannot write " << fileName.toStdString() << std::endl;
+        }
+    }
+}
+
+template <typename Generator>
+void benchmarkMaze(const Engine engine, const RandomAlgorithm random, Generator &generator, const unsigned int size, const int threads, const double errorFactor,
+                   const std::vector<Render> &renders, const int compressionLevel, const QString &fileName) {
+    const Render none{0, 0};
+
+    if (engine == STREAMING) {
+        const Generator initialGenerator = generator;
+        for (const Render &render : renders) {
+            resetPeakMemory();
+            generator = initialGenerator;
+            StreamingMaze maze(size, size);
+            Fingerprint fingerprint(size, size);
+            CountingSink sink((pixelSize(size, render.pathSize, render.wallSize) + 7) / 8);
+            Renderer renderer(size, render.pathSize, render.wallSize, sink);
+
+            const double seconds = measure([&] {
+                renderer.renderTop();
+                maze.generate(generator, errorFactor, [&](unsigned int, const uint64_t *right, const uint64_t *down) {
+                    fingerprint.addRow(right, down, (size + 63) / 64);
+                    renderer.renderRow(right, down);
+                });
+            });
+            report("stream", engineName(engine), random, size, threads, errorFactor, render, seconds, static_cast<double>(sink.bytes()), fingerprint.value());
+        }
+        return;
+    }
+
+    resetPeakMemory();
+    Maze maze(size, size);
+    double seconds = measure([&] {
+        maze.fill();
+    });
+    report("fill", engineName(engine), random, size, threads, errorFactor, none, seconds, static_cast<double>(peakMemory()), 0);
+
+    seconds = measure([&] {
+        maze.connect(engine, generator, errorFactor, threads);
+    });
+    report("connect", engineName(engine), random, size, threads, errorFactor, none, seconds, static_cast<double>(peakMemory()), maze.fingerprint());
+
+    if (maze.size() > MAZE_MAX_INDEXED_CELLS) {
+        benchmarkImage(maze, engineName(engine), random, size, threads, errorFactor, renders, compressionLevel, fileName);
+        return;
+    }
+
+    // Every generated maze is checked, so that an optimization breaking the maze fails loudly.
+    MazeAnalysis analysis;
+    seconds = measure([&] {
+        analysis = analyzeMaze(maze, threads);
+    });
+    report("analyze", engineName(engine), random, size, threads, errorFactor, none, seconds, static_cast<double>(peakMemory()), 0);
+    if (!analysis.isValid(maze.errorCount(errorFactor))) {
+        std::cerr << "Invalid maze: " << analysis.components << " components, " << analysis.loops << " loops" << std::endl;
+    }
+
+    // Only a perfect maze is a tree that can be indexed. One query per cell between random pairs.
+    if (errorFactor == 0) {
+        std::unique_ptr<PathIndex> index;
+        seconds = measure([&] {
+            index = std::make_unique<PathIndex>(maze, threads);
+        });
+        report("index", engineName(engine), random, size, threads, errorFactor, none, seconds, static_cast<double>(peakMemory()), 0);
+
+        std::mt19937 queryGenerator(size);
+        std::uniform_int_distribution<unsigned int> cells(0, size * size - 1);
+        std::vector<std::pair<unsigned int, unsigned int>> queries(static_cast<size_t>(size) * size);
+        for (auto &query : queries) {
+            query = {cells(queryGenerator), cells(queryGenerator)};
+        }
+        seconds = measure([&] {
+            (void) index->distances(queries, threads);
+        });
+        report("query", engineName(engine), random, size, threads, errorFactor, none, seconds, static_cast<double>(peakMemory()), 0);
+    }
+
+    benchmarkImage(maze, engineName(engine), random, size, threads, errorFactor, renders, compressionLevel, fileName);
+}
+
+template <typename T>
+bool parseList(const QCommandLineParser &parser, const QString &name, const std::function<bool(const QString &, T &)> &parse, std::vector<T> &values) {
+    for (const QString &item : parser.value(name).split(',', Qt::SkipEmptyParts)) {
+        T value;
+        if (!parse(item.trimmed(), value)) {
+            std::cerr << "Invalid value for --" << name.toStdString() << ": " << item.toStdString() << std::endl;
+            return false;
+        }
+        values.push_back(value);
+    }
+    if (values.empty()) {
+        std::cerr << "Missing value for --" << name.toStdString() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QString defaultThreads = "1";
+    for (int threads = 2; threads < QThread::idealThreadCount(); threads *= 2) {
+        defaultThreads += "," + QString::number(threads);
+    }
+    if (QThread::idealThreadCount() > 1) {
+        defaultThreads += "," + QString::number(QThread::idealThreadCount());
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures every stage of maze generation and prints one CSV line per measurement.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"seed", "Random seed.", "seed", "0"},
+        {"sizes", "Comma separated maze sizes, in cells per side.", "sizes", "100,1000,5000,20000"},
+        {"threads", "Comma separated thread counts for the tiled engine, the render and png stages.", "threads", defaultThreads},
+        {"errors", "Comma separated error factors.", "errors", "0,0.1,0.5"},
+        {"renders", "Comma separated path:wall sizes in pixels.", "renders", "1:1,2:1,4:2"},
+        {"engines", "Comma separated engines: classic, tiled, streaming, wilson, prim, backtracker, sidewinder, binary-tree.", "engines", "classic,tiled,streaming"},
+        {"interleave", "Interleave large allocations across NUMA nodes."},
+        {"storage", "Map large arrays from temporary files in this directory, for mazes larger than memory.", "directory"},
+        {"randoms", "Comma separated random algorithms: mt19937, xoshiro256-v1, pcg64-v1, splitmix64-v1, xoshiro256-v2, pcg64-v2, splitmix64-v2.", "algorithms", "mt19937"},
+        {"compression", "PNG compression level, from 0 to 9.", "level", "6"},
+    });
+    parser.process(app);
+
+    setNumaInterleave(parser.isSet("interleave"));
+    if (parser.isSet("storage")) {
+        setStorageDirectory(parser.value("storage").toStdString());
+    }
+
+    const auto parseUInt = [](const QString &text, unsigned int &value) {
+        bool ok;
+        value = text.toUInt(&ok);
+        return ok && value != 0;
+    };
+    const auto parseInt = [](const QString &text, int &value) {
+        bool ok;
+        value = text.toInt(&ok);
+        return ok && value > 0;
+    };
+    const auto parseError = [](const QString &text, double &value) {
+        bool ok;
+        value = text.toDouble(&ok);
+        return ok && value >= 0 && value <= 1;
+    };
+    const auto parseRender = [](const QString &text, Render &value) {
+        const QStringList sizes = text.split(':');
+        bool pathOk = false, wallOk = false;
+        if (sizes.size() == 2) {
+            value = {sizes[0].toInt(&pathOk), sizes[1].toInt(&wallOk)};
+        }
+        return pathOk && wallOk && value.pathSize > 0 && value.wallSize > 0;
+    };
+    const auto parseRandom = [](const QString &text, RandomAlgorithm &value) {
+        for (const RandomAlgorithm algorithm : RANDOM_ALGORITHMS) {
+            if (text == randomAlgorithmName(algorithm)) {
+                value = algorithm;
+                return true;
+            }
+        }
+        return false;
+    };
+    const auto parseEngine = [](const QString &text, Engine &value) {
+        for (const Engine engine : ENGINES) {
+            if (text == engineName(engine)) {
+                value = engine;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::vector<unsigned int> sizes;
+    std::vector<int> threadCounts;
+    std::vector<double> errorFactors;
+    std::vector<Render> renders;
+    std::vector<Engine> engines;
+    std::vector<RandomAlgorithm> randoms;
+    int seed, compressionLevel;
+
+    bool ok;
+    seed = parser.value("seed").toInt(&ok);
+    if (!ok) {
+        std::cerr << "Invalid value for --seed: " << parser.value("seed").toStdString() << std::endl;
+        return 1;
+    }
+
+    compressionLevel = parser.value("compression").toInt(&ok);
+    if (!ok || compressionLevel < 0 || compressionLevel > 9) {
+        std::cerr << "Invalid value for --compression: " << parser.value("compression").toStdString() << std::endl;
+        return 1;
+    }
+
+    if (!parseList<unsigned int>(parser, "sizes", parseUInt, sizes)
+        || !parseList<int>(parser, "threads", parseInt, threadCounts)
+        || !parseList<double>(parser, "errors", parseError, errorFactors)
+        || !parseList<Render>(parser, "renders", parseRender, renders)
+        || !parseList<Engine>(parser, "engines", parseEngine, engines)
+        || !parseList<RandomAlgorithm>(parser, "randoms", parseRandom, randoms)) {
+        return 1;
+    }
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        std::cerr << "Cannot create a temporary directory." << std::endl;
+        return 1;
+    }
+    const QString fileName = directory.filePath("benchmark.png");
+
+    std::cout << "# kernel:" << ScanlineBuilder::kernelName() << ", seed:" << seed << ", compression:" << compressionLevel << std::endl;
+    std::cout << "stage,engine,random,size,threads,error,render,ms,cells/s,bytes/cell,peak MiB,fingerprint" << std::endl;
+
+    // Images are only measured for the first error factor since it barely changes their cost.
+    // The streaming engine generates while rendering, so it is always measured with every render.
+    const std::vector<Render> noRenders;
+    for (const unsigned int size : sizes) {
+        for (const double errorFactor : errorFactors) {
+            for (const Engine engine : engines) {
+                const std::vector<Render> &imageRenders = engine == STREAMING || errorFactor == errorFactors.front() ? renders : noRenders;
+                for (const RandomAlgorithm random : randoms) {
+                    if (!canConnect(engine, random, errorFactor, static_cast<uint64_t>(size) * size)) {
+                        continue;
+                    }
+                    for (const int threads : isParallelEngine(engine) ? threadCounts : std::vector{1}) {
+                        withGenerator(random, seed, [&](auto &generator) {
+                            benchmarkMaze(engine, random, generator, size, threads, errorFactor, imageRenders, compressionLevel, fileName);
+                        });
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// A blocking first-in first-out queue between two threads.
+// Producers wait while the queue is full, consumers wait while it is empty and not closed.
+template <typename T>
+class BoundedQueue {
+
+    public:
+
+    explicit BoundedQueue(const size_t capacity) : _capacity(capacity) {};
+
+    void push(T value) {
+        std::unique_lock lock(_mutex);
+        _notFull.wait(lock, [this] { return _values.size() < _capacity; });
+        _values.push_back(std::move(value));
+        _notEmpty.notify_one();
+    }
+
+    bool pop(T &value) {
+        std::unique_lock lock(_mutex);
+        _notEmpty.wait(lock, [this] { return !_values.empty() || _closed; });
+        if (_values.empty()) {
+            return false;
+        }
+        value = std::move(_values.front());
+        _values.pop_front();
+        _notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard lock(_mutex);
+        _closed = true;
+        _notEmpty.notify_all();
+    }
+
+    private:
+
+    size_t _capacity;
+    std::deque<T> _values{};
+    bool _closed = false;
+
+    std::mutex _mutex{};
+    std::condition_variable _notFull{}, _notEmpty{};
+};
+
+#endif //BOUNDED_QUEUE_HPP
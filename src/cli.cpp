@@ -0,0 +1,237 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <climits>
+#include <iostream>
+
+#include "arena.hpp"
+#include "batch.hpp"
+#include "maze_analysis.hpp"
+#include "maze_cache.hpp"
+#include "maze_file.hpp"
+#include "png_writer.hpp"
+#include "tiled_image.hpp"
+#include "worker.hpp"
+
+bool parseInt(const QCommandLineParser &parser, const QString &name, const int minimum, const int maximum, int &value) {
+    bool ok;
+    value = parser.value(name).toInt(&ok);
+    if (!ok || value < minimum || value > maximum) {
+        std::cerr << "Invalid value for --" << name.toStdString() << ": " << parser.value(name).toStdString() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parseRandomAlgorithm(const QString &name, RandomAlgorithm &algorithm) {
+    for (const RandomAlgorithm a : RANDOM_ALGORITHMS) {
+        if (name == randomAlgorithmName(a)) {
+            algorithm = a;
+            return true;
+        }
+    }
+    std::cerr << "Unknown random algorithm: " << name.toStdString() << std::endl;
+    return false;
+}
+
+bool parseEngine(const QString &name, Engine &engine) {
+    for (const Engine e : ENGINES) {
+        if (name == engineName(e)) {
+            engine = e;
+            return true;
+        }
+    }
+    std::cerr << "Unknown engine: " << name.toStdString() << std::endl;
+    return false;
+}
+
+// Prints the statistics of a maze and checks that it has as many loops as its parameters ask for.
+// The streaming engine draws each loop independently, so only their presence can be checked.
+bool printAnalysis(const Maze &maze, const MazeFileInfo &info, const int threads) {
+    if (maze.size() > MAZE_MAX_INDEXED_CELLS) {
+        std::cerr << "The analysis is limited to " << MAZE_MAX_INDEXED_CELLS << " cells" << std::endl;
+        return false;
+    }
+
+    const MazeAnalysis analysis = analyzeMaze(maze, threads);
+
+    std::cout << "Connections: " << analysis.connections << ", components: " << analysis.components << ", loops: " << analysis.loops << std::endl;
+    std::cout << "Dead ends: " << analysis.deadEnds() << ", corridors: " << analysis.degrees[2] << ", junctions: " << analysis.junctions()
+        << ", isolated: " << analysis.degrees[0] << std::endl;
+    std::cout << "Diameter: " << analysis.diameter << " (" << analysis.diameterStart % info.width << "," << analysis.diameterStart / info.width
+        << " to " << analysis.diameterEnd % info.width << "," << analysis.diameterEnd / info.width << ")" << std::endl;
+    std::cout << "Corridor lengths:";
+    for (size_t length = 1; length < analysis.corridorLengths.size(); length++) {
+        if (analysis.corridorLengths[length] != 0) {
+            std::cout << " " << length << ":" << analysis.corridorLengths[length];
+        }
+    }
+    std::cout << std::endl;
+
+    bool valid;
+    if (static_cast<Engine>(info.engine) == STREAMING) {
+        valid = analysis.isConnected() && (info.errorFactor != 0 || analysis.loops == 0);
+    } else {
+        valid = analysis.isValid(maze.errorCount(info.errorFactor));
+    }
+    std::cout << "Validation " << (valid ? "succeeded" : "failed") << "." << std::endl;
+    return valid;
+}
+
+// Renders a saved maze again, for example with other path and wall sizes, or only analyzes it when there is no output.
+bool renderMazeFile(const QString &mazeFileName, const WorkerParameters &parameters, const bool analyze) {
+    MazeFileInfo info;
+    const std::unique_ptr<Maze> maze = Maze::load(mazeFileName, info, parameters.threads);
+    if (maze == nullptr) {
+        std::cerr << "Cannot read maze file: " << mazeFileName.toStdString() << std::endl;
+        return false;
+    }
+
+    std::cout << "Loaded maze. (" << info.width << "x" << info.height << ", error:" << info.errorFactor << ", seed:" << info.seed
+        << ", engine:" << engineName(static_cast<Engine>(info.engine)) << ", random:" << randomAlgorithmName(info.randomAlgorithm) << ")" << std::endl;
+
+    const bool valid = !analyze || printAnalysis(*maze, info, parameters.threads);
+    if (parameters.fileName.isEmpty()) {
+        return valid;
+    }
+
+    if (isTiledImageFile(parameters.fileName) || exceedsPngSize(info.width, info.height, parameters.pathSize, parameters.wallSize)) {
+        const TiledImage image(*maze, parameters.pathSize, parameters.wallSize);
+        const bool writeResult = image.write(tiledImageFileName(parameters.fileName), parameters.compressionLevel, parameters.threads, *maze->_progress);
+        std::cout << "Write " << (writeResult ? "succeeded" : "failed") << "." << std::endl;
+        return valid && writeResult;
+    }
+
+    PngWriter writer(parameters.fileName, parameters.compressionLevel, parameters.threads);
+    if (!writer.open(pixelSize(info.width, parameters.pathSize, parameters.wallSize), pixelSize(info.height, parameters.pathSize, parameters.wallSize))) {
+        return false;
+    }
+    maze->generateImage(parameters.pathSize, parameters.wallSize, writer, parameters.threads);
+    const bool writeResult = writer.finish();
+    std::cout << "Write " << (writeResult ? "succeeded" : "failed") << "." << std::endl;
+    return valid && writeResult;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates a PNG image of a random perfect maze.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"seed", "Random seed.", "seed", "0"},
+        {"width", "Width in cells.", "width", "30"},
+        {"height", "Height in cells.", "height", "30"},
+        {"error", "Error factor, between 0 and 1.", "error", "0"},
+        {"path", "Path size in pixels.", "pixels", "2"},
+        {"wall", "Wall size in pixels.", "pixels", "1"},
+        {"engine", "Generation engine: classic, tiled, streaming, wilson, prim, backtracker, sidewinder or binary-tree.", "engine", "classic"},
+        {"threads", "Number of threads, 0 for all cores.", "threads", "0"},
+        {"compression", "PNG compression level, from 0 to 9.", "level", "6"},
+        {"random", "Random algorithm: mt19937, or xoshiro256, pcg64 or splitmix64 followed by -v1 or -v2.", "algorithm", "mt19937"},
+        {"interleave", "Interleave large allocations across NUMA nodes."},
+        {"storage", "Map large arrays from temporary files in this directory, for mazes larger than memory.", "directory"},
+        {"save", "Also save the walls to a maze file, which can be rendered again with --load.", "file"},
+        {"load", "Render a saved maze file instead of generating a maze.", "file"},
+        {"analyze", "Print the statistics of the maze loaded with --load and check that it is connected with the expected loops. The output is then optional."},
+        {"cache", "Look up generated mazes and images in this cache directory, and store them there.", "directory"},
+        {"cache-size", "Maximum size of the cache in MiB.", "size", "1024"},
+        {"batch", "Generate all the mazes listed in a manifest, one per line: seed,width,height,error,path,wall,output[,engine[,compression[,random]]].", "manifest"},
+    });
+    parser.addPositionalArgument("output", "Output PNG file, .dzi for a Deep Zoom pyramid or .json for a grid of PNG tiles.");
+    parser.process(app);
+
+    setNumaInterleave(parser.isSet("interleave"));
+    if (parser.isSet("storage")) {
+        setStorageDirectory(parser.value("storage").toStdString());
+    }
+
+    const QStringList arguments = parser.positionalArguments();
+    if (parser.isSet("batch")) {
+        if (!arguments.isEmpty()) {
+            parser.showHelp(1);
+        }
+
+        int threads;
+        std::vector<WorkerParameters> jobs;
+        if (!parseInt(parser, "threads", 0, INT_MAX, threads) || !Batch::readManifest(parser.value("batch"), threads, jobs)) {
+            return 1;
+        }
+
+        Batch batch(std::move(jobs));
+        return batch.run() ? 0 : 1;
+    }
+
+    const bool analyze = parser.isSet("analyze");
+    if (analyze && !parser.isSet("load")) {
+        std::cerr << "--analyze requires --load" << std::endl;
+        return 1;
+    }
+    if (arguments.size() > 1 || (arguments.isEmpty() && !analyze)) {
+        parser.showHelp(1);
+    }
+
+    WorkerParameters parameters{};
+    parameters.fileName = arguments.value(0);
+
+    bool ok = parseInt(parser, "seed", INT_MIN, INT_MAX, parameters.seed)
+        && parseInt(parser, "width", 1, INT_MAX, parameters.width)
+        && parseInt(parser, "height", 1, INT_MAX, parameters.height)
+        && parseInt(parser, "path", 1, INT_MAX, parameters.pathSize)
+        && parseInt(parser, "wall", 1, INT_MAX, parameters.wallSize)
+        && parseInt(parser, "threads", 0, INT_MAX, parameters.threads)
+        && parseInt(parser, "compression", 0, 9, parameters.compressionLevel)
+        && parseEngine(parser.value("engine"), parameters.engine)
+        && parseRandomAlgorithm(parser.value("random"), parameters.randomAlgorithm);
+
+    if (ok) {
+        parameters.errorFactor = parser.value("error").toDouble(&ok);
+        if (!ok || parameters.errorFactor < 0 || parameters.errorFactor > 1) {
+            std::cerr << "Invalid value for --error: " << parser.value("error").toStdString() << std::endl;
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        return 1;
+    }
+
+    if (parser.isSet("load")) {
+        return renderMazeFile(parser.value("load"), parameters, analyze) ? 0 : 1;
+    }
+
+    parameters.mazeFileName = parser.value("save");
+
+    Worker worker(parameters);
+    if (parser.isSet("cache")) {
+        int cacheSize;
+        if (!parseInt(parser, "cache-size", 0, INT_MAX, cacheSize)) {
+            return 1;
+        }
+        worker.setCache(std::make_shared<MazeCache>(parser.value("cache"), qint64{cacheSize} << 20));
+    }
+    worker.run();
+
+    return worker.hasSucceeded() ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "deep_zoom.hpp"
+
+#include <QDir>
+#include <QSaveFile>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <vector>
+
+#include "parallel.hpp"
+#include "png_writer.hpp"
+
+bool isDeepZoomFile(const QString &fileName) {
+    return fileName.endsWith(".dzi", Qt::CaseInsensitive);
+}
+
+unsigned int popcountRange(const uint64_t *row, const unsigned int from, const unsigned int to) {
+    if (from >= to) {
+        return 0;
+    }
+
+    const unsigned int firstWord = from >> 6, lastWord = (to - 1) >> 6;
+    const uint64_t firstMask = ~uint64_t{0} << (from & 63), lastMask = ~uint64_t{0} >> (63 - ((to - 1) & 63));
+    if (firstWord == lastWord) {
+        return std::popcount(row[firstWord] & firstMask & lastMask);
+    }
+
+    unsigned int count = std::popcount(row[firstWord] & firstMask) + std::popcount(row[lastWord] & lastMask);
+    for (unsigned int word = firstWord + 1; word < lastWord; word++) {
+        count += std::popcount(row[word]);
+    }
+    return count;
+}
+
+DeepZoom::DeepZoom(const Maze &maze, const int pathSize, const int wallSize) :
+    _maze(maze), _pathSize(pathSize), _wallSize(wallSize), _period(pathSize + wallSize),
+    _width(pixelSize(maze.width(), pathSize, wallSize)), _height(pixelSize(maze.height(), pathSize, wallSize)) {
+    const uint64_t size = std::max(_width, _height);
+    _levels = 1;
+    while (uint64_t{1} << (_levels - 1) < size) {
+        _levels++;
+    }
+}
+
+unsigned int DeepZoom::levelCount() const {
+    return _levels;
+}
+
+uint64_t DeepZoom::width(const unsigned int level) const {
+    const unsigned int shift = _levels - 1 - level;
+    return (_width + (uint64_t{1} << shift) - 1) >> shift;
+}
+
+uint64_t DeepZoom::height(const unsigned int level) const {
+    const unsigned int shift = _levels - 1 - level;
+    return (_height + (uint64_t{1} << shift) - 1) >> shift;
+}
+
+// The spans of the columns are computed once for the whole region.
+void DeepZoom::render(const unsigned int level, const uint64_t left, const uint64_t top, const unsigned int width, const unsigned int height, uint8_t *pixels, const size_t stride) const {
+    const unsigned int shift = _levels - 1 - level;
+
+    std::vector<DeepZoomSpan> columns(width);
+    for (unsigned int u = 0; u < width; u++) {
+        const uint64_t x0 = (left + u) << shift;
+        columns[u] = span(x0, std::min(x0 + (uint64_t{1} << shift), _width));
+    }
+
+    for (unsigned int v = 0; v < height; v++) {
+        const uint64_t y0 = (top + v) << shift, y1 = std::min(y0 + (uint64_t{1} << shift), _height);
+        const DeepZoomSpan row = span(y0, y1);
+        for (unsigned int u = 0; u < width; u++) {
+            const auto area = static_cast<double>(columns[u].size * row.size);
+            pixels[v * stride + u] = static_cast<uint8_t>(std::lround(255 * static_cast<double>(whitePixels(columns[u], row)) / area));
+        }
+    }
+}
+
+// The image starts with a wall, then each cell is a run of path pixels followed by a run of wall pixels, on both axes.
+DeepZoomSpan DeepZoom::span(const uint64_t start, const uint64_t end) const {
+    if (end <= _wallSize) {
+        return {end - start, 0, 0, 0, 0, 0, true};
+    }
+
+    const uint64_t first = std::max(start, _wallSize) - _wallSize, last = end - _wallSize;
+    return {
+        end - start,
+        first, last,
+        static_cast<unsigned int>(first / _period), static_cast<unsigned int>((last - 1) / _period),
+        pathBefore(last) - pathBefore(first),
+        false
+    };
+}
+
+// Path pixels of both axes are always white, the others are only white where the cells are connected.
+uint64_t DeepZoom::whitePixels(const DeepZoomSpan &x, const DeepZoomSpan &y) const {
+    if (x.empty || y.empty) {
+        return 0;
+    }
+
+    uint64_t white = x.paths * y.paths;
+    for (unsigned int row = y.first; row <= y.last; row++) {
+        if (const uint64_t pathRows = overlap(row, true, y.start, y.end); pathRows != 0) {
+            white += pathRows * weightedCount(_maze.rightRow(row), x.first, x.last, false, x.start, x.end);
+        }
+        if (const uint64_t wallRows = overlap(row, false, y.start, y.end); wallRows != 0) {
+            white += wallRows * weightedCount(_maze.downRow(row), x.first, x.last, true, x.start, x.end);
+        }
+    }
+    return white;
+}
+
+uint64_t DeepZoom::pathBefore(const uint64_t position) const {
+    return position / _period * _pathSize + std::min(position % _period, _pathSize);
+}
+
+uint64_t DeepZoom::overlap(const unsigned int cell, const bool path, const uint64_t start, const uint64_t end) const {
+    const uint64_t low = cell * _period + (path ? 0 : _pathSize), high = low + (path ? _pathSize : _wallSize);
+    const uint64_t a = std::max(low, start), b = std::min(high, end);
+    return a < b ? b - a : 0;
+}
+
+// Only the first and last cells may be partially covered, the others are counted at once.
+uint64_t DeepZoom::weightedCount(const uint64_t *row, const unsigned int first, const unsigned int last, const bool path, const uint64_t start, const uint64_t end) const {
+    const auto bit = [row](const unsigned int cell) {
+        return row[cell >> 6] >> (cell & 63) & 1;
+    };
+
+    uint64_t count = bit(first) * overlap(first, path, start, end);
+    if (last != first) {
+        count += bit(last) * overlap(last, path, start, end);
+        count += (path ? _pathSize : _wallSize) * popcountRange(row, first + 1, last);
+    }
+    return count;
+}
+
+// Tiles of every level are rendered and written concurrently, each one to its own file.
+// The descriptor is written last, so a viewer never opens an incomplete pyramid.
+bool DeepZoom::write(const QString &fileName, const int compressionLevel, const int threads, Progress &progress) const {
+    const QString directory = fileName.left(fileName.size() - 4) + "_files";
+
+    std::vector<uint64_t> firstTiles(_levels + 1, 0);
+    for (unsigned int level = 0; level < _levels; level++) {
+        const uint64_t columns = (width(level) + DEEP_ZOOM_TILE_SIZE - 1) / DEEP_ZOOM_TILE_SIZE;
+        const uint64_t rows = (height(level) + DEEP_ZOOM_TILE_SIZE - 1) / DEEP_ZOOM_TILE_SIZE;
+        firstTiles[level + 1] = firstTiles[level] + columns * rows;
+
+        if (!QDir().mkpath(QString("%1/%2").arg(directory).arg(level))) {
+            return false;
+        }
+    }
+
+    const auto tiles = static_cast<unsigned int>(firstTiles[_levels]);
+    std::atomic<bool> failed{false};
+    progress.start(TILING, tiles);
+
+    parallelFor(tiles, threads, [&](const unsigned int tile) {
+        if (progress.isCancelled() || failed.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const auto level = static_cast<unsigned int>(std::upper_bound(firstTiles.begin(), firstTiles.end(), tile) - firstTiles.begin() - 1);
+        const uint64_t columns = (width(level) + DEEP_ZOOM_TILE_SIZE - 1) / DEEP_ZOOM_TILE_SIZE;
+        const uint64_t column = (tile - firstTiles[level]) % columns, row = (tile - firstTiles[level]) / columns;
+        const uint64_t left = column * DEEP_ZOOM_TILE_SIZE, top = row * DEEP_ZOOM_TILE_SIZE;
+        const auto tileWidth = static_cast<unsigned int>(std::min<uint64_t>(DEEP_ZOOM_TILE_SIZE, width(level) - left));
+        const auto tileHeight = static_cast<unsigned int>(std::min<uint64_t>(DEEP_ZOOM_TILE_SIZE, height(level) - top));
+
+        std::vector<uint8_t> pixels(static_cast<size_t>(tileWidth) * tileHeight);
+        render(level, left, top, tileWidth, tileHeight, pixels.data(), tileWidth);
+
+        PngWriter writer(QString("%1/%2/%3_%4.png").arg(directory).arg(level).arg(column).arg(row), compressionLevel);
+        if (!writer.open(tileWidth, tileHeight, 8)) {
+            failed.store(true, std::memory_order_relaxed);
+            return;
+        }
+        for (unsigned int y = 0; y < tileHeight; y++) {
+            writer.writeLines(pixels.data() + static_cast<size_t>(y) * tileWidth, 1);
+        }
+        if (!writer.finish()) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+
+        progress.add(1);
+    });
+
+    if (failed.load(std::memory_order_relaxed) || progress.isCancelled()) {
+        return false;
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QString(R"(<?xml version="1.0" encoding="UTF-8"?>
+<Image xmlns="http://schemas.microsoft.com/deepzoom/2008" TileSize="%1" Overlap="0" Format="png">
+    <Size Width="%2" Height="%3"/>
+</Image>
+)").arg(DEEP_ZOOM_TILE_SIZE).arg(_width).arg(_height).toUtf8());
+    return file.commit();
+}
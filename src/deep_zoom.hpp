@@ -0,0 +1,83 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef DEEP_ZOOM_HPP
+#define DEEP_ZOOM_HPP
+
+#include <QString>
+#include <cstdint>
+#include "maze.hpp"
+
+constexpr unsigned int DEEP_ZOOM_TILE_SIZE = 256;
+
+// A range of pixels along one axis, relative to the end of the leading wall, with the cells it covers.
+struct DeepZoomSpan {
+    uint64_t size;
+    uint64_t start, end;
+    unsigned int first, last;
+    uint64_t paths;
+    bool empty;
+};
+
+bool isDeepZoomFile(const QString &fileName);
+
+// Renders a maze at any power of two zoom out without building the full image.
+// Each pixel of a level is the fraction of white pixels of the full image it covers,
+// counted from the wall grid with one popcount per row of cells instead of one test per pixel.
+class DeepZoom {
+    public:
+
+    DeepZoom(const Maze &maze, int pathSize, int wallSize);
+
+    // The last level is the full image, each previous one is half the size of the next one, down to a single pixel.
+    [[nodiscard]] unsigned int levelCount() const;
+
+    [[nodiscard]] uint64_t width(unsigned int level) const;
+
+    [[nodiscard]] uint64_t height(unsigned int level) const;
+
+    // Writes 8-bit gray pixels of a region of a level to rows of the given stride in bytes.
+    void render(unsigned int level, uint64_t left, uint64_t top, unsigned int width, unsigned int height, uint8_t *pixels, size_t stride) const;
+
+    // Writes the pyramid in the Deep Zoom format: an XML descriptor and a directory of PNG tiles per level.
+    bool write(const QString &fileName, int compressionLevel, int threads, Progress &progress) const;
+
+    private:
+
+    [[nodiscard]] DeepZoomSpan span(uint64_t start, uint64_t end) const;
+
+    [[nodiscard]] uint64_t whitePixels(const DeepZoomSpan &x, const DeepZoomSpan &y) const;
+
+    [[nodiscard]] uint64_t pathBefore(uint64_t position) const;
+
+    [[nodiscard]] uint64_t overlap(unsigned int cell, bool path, uint64_t start, uint64_t end) const;
+
+    [[nodiscard]] uint64_t weightedCount(const uint64_t *row, unsigned int first, unsigned int last, bool path, uint64_t start, uint64_t end) const;
+
+    const Maze &_maze;
+    const uint64_t _pathSize, _wallSize, _period;
+    const uint64_t _width, _height;
+    unsigned int _levels;
+};
+
+
+#endif //DEEP_ZOOM_HPP
@@ -24,9 +24,10 @@
 
 #include <array>
 
-typedef std::array<DirectionCombination, 24> DirectionCombinationSet;
+typedef std::array<DirectionCombination, DIRECTION_COMBINATION_COUNT> DirectionCombinationSet;
 
-void computeCombinations(DirectionCombinationSet& combinations) {
+DirectionCombinationSet computeCombinations() {
+    DirectionCombinationSet combinations;
     int i = 0;
     for (const Direction& d1 : DIRECTIONS) {
         for (const Direction& d2 : DIRECTIONS) {
@@ -46,16 +47,10 @@ void computeCombinations(DirectionCombinationSet& combinations) {
             }
         }
     }
+    return combinations;
 }
 
-DirectionCombinationSet combinationsCache;
-bool combinationsCacheInitialized = false;
-
-DirectionCombination& randomDirectionCombination(std::mt19937 &generator) {
-    if (!combinationsCacheInitialized) {
-        computeCombinations(combinationsCache);
-        combinationsCacheInitialized = true;
-    }
-    static std::uniform_int_distribution distribution(0, 23);
-    return combinationsCache[distribution(generator)];
+const DirectionCombination& directionCombination(const int index) {
+    static const DirectionCombinationSet combinations = computeCombinations();
+    return combinations[index];
 }
@@ -24,7 +24,7 @@
 #define DIRECTION_HPP
 
 #include <array>
-#include <random>
+#include "random.hpp"
 
 enum Direction {UP, DOWN, LEFT, RIGHT};
 
@@ -32,6 +32,13 @@ typedef std::array<Direction, 4> DirectionCombination;
 
 constexpr DirectionCombination DIRECTIONS = {UP, DOWN, LEFT, RIGHT};
 
-DirectionCombination& randomDirectionCombination(std::mt19937 &generator);
+constexpr int DIRECTION_COMBINATION_COUNT = 24;
+
+const DirectionCombination& directionCombination(int index);
+
+template <typename Generator>
+int randomDirectionCombinationIndex(Generator &generator) {
+    return static_cast<int>(randomBelow(generator, DIRECTION_COMBINATION_COUNT));
+}
 
 #endif //DIRECTION_HPP
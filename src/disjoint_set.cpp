@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "disjoint_set.hpp"
+
+#include <algorithm>
+#include <utility>
+
+void DisjointSetStatistics::add(const DisjointSetStatistics &other) {
+    finds += other.finds;
+    steps += other.steps;
+    maxDepth = std::max(maxDepth, other.maxDepth);
+}
+
+void DisjointSet::resize(const unsigned int size) {
+    _links.reset(size);
+    _ranks.reset(size);
+    _statistics = {};
+}
+
+void DisjointSet::advise(const ArenaAccess access) {
+    _links.advise(access);
+    _ranks.advise(access);
+}
+
+void DisjointSet::makeSet(const unsigned int element) {
+    _links[element] = 0;
+    _ranks[element] = 0;
+}
+
+bool DisjointSet::unite(const unsigned int a, const unsigned int b) {
+    return unite(a, b, _statistics);
+}
+
+bool DisjointSet::unite(const unsigned int a, const unsigned int b, DisjointSetStatistics &statistics) {
+    const unsigned int rootA = find(a, statistics), rootB = find(b, statistics);
+    if (rootA == rootB) {
+        return false;
+    }
+    link(rootA, rootB);
+    return true;
+}
+
+unsigned int DisjointSet::link(unsigned int rootA, unsigned int rootB) {
+    if (_ranks[rootA] > _ranks[rootB]) {
+        std::swap(rootA, rootB);
+    } else if (_ranks[rootA] == _ranks[rootB]) {
+        _ranks[rootB]++;
+    }
+    _links[rootA] = rootA ^ rootB;
+    return rootB;
+}
+
+const DisjointSetStatistics& DisjointSet::statistics() const {
+    return _statistics;
+}
+
+void DisjointSet::addStatistics(const DisjointSetStatistics &statistics) {
+    _statistics.add(statistics);
+}
@@ -0,0 +1,93 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef DISJOINT_SET_HPP
+#define DISJOINT_SET_HPP
+
+#include <cstdint>
+#include "arena.hpp"
+
+struct DisjointSetStatistics {
+    uint64_t finds = 0;
+    uint64_t steps = 0;
+    unsigned int maxDepth = 0;
+
+    void add(const DisjointSetStatistics &other);
+};
+
+// Each element stores its parent xor itself, so a zeroed array is a forest of singletons and needs no initialization pass.
+class DisjointSet {
+    public:
+
+    void resize(unsigned int size);
+
+    void advise(ArenaAccess access);
+
+    void makeSet(unsigned int element);
+
+    unsigned int find(unsigned int element);
+
+    unsigned int find(unsigned int element, DisjointSetStatistics &statistics);
+
+    bool unite(unsigned int a, unsigned int b);
+
+    bool unite(unsigned int a, unsigned int b, DisjointSetStatistics &statistics);
+
+    // Links two distinct roots and returns the root of the merged set.
+    unsigned int link(unsigned int rootA, unsigned int rootB);
+
+    [[nodiscard]] const DisjointSetStatistics& statistics() const;
+
+    void addStatistics(const DisjointSetStatistics &statistics);
+
+    private:
+
+    ZeroedArray<uint32_t> _links{};
+    ZeroedArray<uint8_t> _ranks{};
+    DisjointSetStatistics _statistics{};
+};
+
+inline unsigned int DisjointSet::find(const unsigned int element) {
+    return find(element, _statistics);
+}
+
+// Iterative path halving: every visited element is linked to its grandparent.
+inline unsigned int DisjointSet::find(unsigned int element, DisjointSetStatistics &statistics) {
+    unsigned int depth = 0;
+    unsigned int parent = _links[element] ^ element;
+    while (parent != element) {
+        const unsigned int grandparent = _links[parent] ^ parent;
+        _links[element] = grandparent ^ element;
+        element = grandparent;
+        parent = _links[element] ^ element;
+        depth++;
+    }
+
+    statistics.finds++;
+    statistics.steps += depth;
+    if (depth > statistics.maxDepth) {
+        statistics.maxDepth = depth;
+    }
+    return element;
+}
+
+#endif //DISJOINT_SET_HPP
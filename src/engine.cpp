@@ -0,0 +1,49 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "engine.hpp"
+
+const char* engineName(const Engine engine) {
+    switch (engine) {
+        case CLASSIC:
+            return "classic";
+        case TILED:
+            return "tiled";
+        case STREAMING:
+            return "streaming";
+        case WILSON:
+            return "wilson";
+        case PRIM:
+            return "prim";
+        case BACKTRACKER:
+            return "backtracker";
+        case SIDEWINDER:
+            return "sidewinder";
+        case BINARY_TREE:
+            return "binary-tree";
+    }
+    return "unknown";
+}
+
+bool isParallelEngine(const Engine engine) {
+    return engine == TILED || engine == SIDEWINDER || engine == BINARY_TREE;
+}
@@ -0,0 +1,37 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+// Identifies the algorithm generating a maze. Values are stored in maze files, so new engines are only appended.
+// The streaming engine generates rows while they are rendered and never holds a whole maze.
+enum Engine {CLASSIC, TILED, STREAMING, WILSON, PRIM, BACKTRACKER, SIDEWINDER, BINARY_TREE};
+
+constexpr Engine ENGINES[] = {CLASSIC, TILED, STREAMING, WILSON, PRIM, BACKTRACKER, SIDEWINDER, BINARY_TREE};
+
+const char* engineName(Engine engine);
+
+// Engines whose result does not depend on the number of threads they are given.
+bool isParallelEngine(Engine engine);
+
+#endif //ENGINE_HPP
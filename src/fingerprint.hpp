@@ -0,0 +1,60 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef FINGERPRINT_HPP
+#define FINGERPRINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a hash of the wall grid, fed one row at a time, to check that two runs produced the same maze.
+class Fingerprint {
+    public:
+
+    Fingerprint(const unsigned int width, const unsigned int height) {
+        add(width);
+        add(height);
+    }
+
+    void addRow(const uint64_t *right, const uint64_t *down, const size_t words) {
+        for (size_t i = 0; i < words; i++) {
+            add(right[i]);
+        }
+        for (size_t i = 0; i < words; i++) {
+            add(down[i]);
+        }
+    }
+
+    [[nodiscard]] uint64_t value() const {
+        return _hash;
+    }
+
+    private:
+
+    void add(const uint64_t word) {
+        _hash = (_hash ^ word) * 0x100000001b3;
+    }
+
+    uint64_t _hash = 0xcbf29ce484222325;
+};
+
+#endif //FINGERPRINT_HPP
@@ -21,6 +21,7 @@
 */
 
 #include <QApplication>
+#include <QPixmap>
 
 #include "maze.hpp"
 #include "user_interface.hpp"
@@ -35,7 +36,7 @@ int main(int argc, char *argv[]) {
         maze.fill();
         maze.connectAll(generator, 0);
 
-        QApplication::setWindowIcon(QIcon(maze.generateImage(2, 1)));
+        QApplication::setWindowIcon(QIcon(QPixmap::fromImage(maze.generateImage(2, 1))));
     }
 
     UserInterface ui;
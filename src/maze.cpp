@@ -22,315 +22,786 @@
 
 #include "maze.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cmath>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
 
-#include "random_queue.hpp"
-#include "vector_util.hpp"
+#include "fingerprint.hpp"
+#include "maze_file.hpp"
+#include "parallel.hpp"
+#include "random_permutation.hpp"
+#include "renderer.hpp"
 
-#include <QPainter>
+namespace {
 
-Maze::Maze(const unsigned int width, const unsigned int height) : _worker(nullptr), _width(width), _height(height), _size(width * height), _lastUpdate(-1) {
-    _points.reserve(_size);
+// Cells of the sides of a tile, left and right columns then top and bottom rows.
+enum TileSide {LEFT_SIDE, RIGHT_SIDE, TOP_SIDE, BOTTOM_SIDE};
+
+constexpr unsigned int TILE_SIDES = 4;
+
+// Marks the cells of the sides whose wall is the exit of their component.
+constexpr uint16_t TILE_EXIT = 0x8000;
+
+constexpr unsigned int OUTSIDE_CELL = UINT32_MAX;
+
+size_t sideIndex(const unsigned int tile, const TileSide side, const unsigned int offset) {
+    return (static_cast<size_t>(tile) * TILE_SIDES + side) * MAZE_TILE_SIZE + offset;
 }
 
-void Maze::fill() {
-    forceUpdate(0);
+}
 
-    for (int i = 0; i < _size; i++) {
-        _points.emplace_back(*this, i);
-        update(i / static_cast<double>(_size));
+bool canConnect(const Engine engine, const RandomAlgorithm randomAlgorithm, const double errorFactor, const uint64_t cells) {
+    if (cells <= MAZE_MAX_INDEXED_CELLS || engine == STREAMING) {
+        return true;
     }
+    if (!isParallelEngine(engine)) {
+        return false;
+    }
+    const bool samplesLoops = randomAlgorithm == XOSHIRO256_V2 || randomAlgorithm == PCG64_V2 || randomAlgorithm == SPLITMIX64_V2;
+    return engine != TILED || errorFactor == 0 || samplesLoops;
+}
+
+Maze::Maze(const unsigned int width, const unsigned int height) : _progress(std::make_shared<Progress>()), _width(width), _height(height), _size(static_cast<uint64_t>(width) * height), _stride((width + 63) / 64) {}
+
+// Every array starts zeroed: each cell is its own set, with no connection and no direction tried.
+// Pages are only materialized when the connect stage first touches them.
+void Maze::fill() {
+    _progress->start(FILLING, _size);
 
-    forceUpdate(1);
+    _right.reset(static_cast<size_t>(_stride) * _height);
+    _down.reset(static_cast<size_t>(_stride) * _height);
+    _directions.reset(_size);
+
+    _progress->finish();
 }
 
-void Maze::connectAll(std::mt19937 &generator, const double errorFactor) {
+template <typename Generator>
+void Maze::connectAll(Generator &generator, const double errorFactor) {
     if (errorFactor < 0 || errorFactor > 1) {
         throw std::range_error("Error factor must be between 0 and 1");
     }
 
-    if (isCancelled()) {
+    checkIndexedSize("The classic engine");
+
+    if (_progress->isCancelled()) {
         return;
     }
 
-    forceUpdate(0);
+    _set.resize(static_cast<unsigned int>(_size));
+
+    // Cells are visited in a global random order, so read-ahead would only waste page faults.
+    advise(RANDOM_ACCESS);
+
+    _progress->start(SHUFFLING, _size);
 
     for (unsigned int i = 0; i < _size; i++) {
-        _points[i].shuffleDirectionCombination(generator);
-        update(i / static_cast<double>(_size));
+        shuffleDirectionCombination(i, generator);
+        _progress->update(i + 1);
     }
 
-    forceUpdate(0);
-
-    const unsigned int max = _size - 1;
+    const Region region = {0, 0, _width, _height};
+    const auto max = static_cast<unsigned int>(_size - 1);
     unsigned int connections = 0;
-    RandomQueue queue(toPointers(_points), generator);
+    auto order = randomOrder(static_cast<uint32_t>(_size), generator);
+    DisjointSetStatistics statistics;
+    const auto join = [&](const unsigned int a, const unsigned int b, Direction) {
+        return b != OUTSIDE_CELL && _set.unite(a, b, statistics);
+    };
+    _progress->start(CONNECTING, max);
+
+    while (connections != max && !_progress->isCancelled()) {
+        if (tryConnect(order.next(), region, join)) {
+            _progress->update(++connections);
+        }
+    }
+
+    _set.addStatistics(statistics);
+
+    if (_progress->isCancelled()) {
+        return;
+    }
+
+    _progress->finish();
 
-    while (connections != max && !isCancelled()) {
-        if (queue.next()->tryConnect()) {
-            update(++connections / static_cast<double>(max));
+    if (const uint64_t errors = errorCount(errorFactor); errors != 0) {
+        if constexpr (SAMPLES_LOOPS<Generator>) {
+            connectSampledErrors(errors, generator);
+        } else {
+            order.reset();
+            connectErrors(static_cast<unsigned int>(errors), order);
+        }
+    }
+}
+
+template <typename Generator>
+void Maze::connectAllTiled(Generator &generator, const double errorFactor, const int threads) {
+    if (errorFactor < 0 || errorFactor > 1) {
+        throw std::range_error("Error factor must be between 0 and 1");
+    }
+
+    if constexpr (!SAMPLES_LOOPS<Generator>) {
+        if (errorCount(errorFactor) != 0) {
+            checkIndexedSize("A v1 random algorithm with loops");
         }
     }
 
-    if (isCancelled()) {
+    if (_progress->isCancelled()) {
         return;
     }
 
-    forceUpdate(1);
+    // Each tile is connected independently with its own generator, seeded from the main generator and the tile index,
+    // so the result does not depend on the number of threads nor on the order in which tiles are processed.
+    const unsigned int tilesX = (_width + MAZE_TILE_SIZE - 1) / MAZE_TILE_SIZE, tilesY = (_height + MAZE_TILE_SIZE - 1) / MAZE_TILE_SIZE;
+    const unsigned int tiles = tilesX * tilesY;
+    const typename Generator::result_type seed = generator();
+
+    // Tiles are claimed in row-major order, so the threads sweep the arrays from one band of tiles to the next.
+    advise(NORMAL_ACCESS);
+
+    _progress->start(CONNECTING, tiles);
+    std::vector<TileForest> forests(tiles);
+    ZeroedArray<uint16_t> sides(static_cast<size_t>(tiles) * TILE_SIDES * MAZE_TILE_SIZE);
+    std::mutex mutex;
+
+    parallelFor(tiles, threads, [&](const unsigned int tile) {
+        if (_progress->isCancelled()) {
+            return;
+        }
 
-    const unsigned int errors = std::lround((_size - _width - _height + 1) * errorFactor);
-    if (errors == 0) {
+        Generator tileGenerator = makeTileGenerator<Generator>(seed, tile);
+        DisjointSetStatistics statistics;
+        connectTile(tile, tilesX, tilesY, tileGenerator, forests[tile], sides.data() + static_cast<size_t>(tile) * TILE_SIDES * MAZE_TILE_SIZE, statistics);
+
+        _progress->add(1);
+
+        std::lock_guard lock(mutex);
+        _set.addStatistics(statistics);
+    });
+
+    if (_progress->isCancelled()) {
         return;
     }
 
-    forceUpdate(0);
+    // The forests are then joined by Kruskal's algorithm over their components, which keeps the maze perfect. The exits are
+    // opened first, then the other border walls and one wall per pair of neighboring components of a tile compete in one order.
+    std::vector<uint64_t> componentOffsets(tiles + 1), doorOffsets(tiles + 1);
+    for (unsigned int tile = 0; tile < tiles; tile++) {
+        componentOffsets[tile + 1] = componentOffsets[tile] + forests[tile].components;
+        doorOffsets[tile + 1] = doorOffsets[tile] + forests[tile].doors.size();
+    }
+    if (componentOffsets[tiles] > UINT32_MAX) {
+        throw std::length_error("The tiled engine is limited to " + std::to_string(UINT32_MAX) + " tile components");
+    }
 
+    const uint64_t borders = static_cast<uint64_t>(tilesX - 1) * _height + static_cast<uint64_t>(tilesY - 1) * _width;
+    const uint64_t max = componentOffsets[tiles] - 1;
+    uint64_t connections = 0;
+    _progress->start(JOINING, max);
+    DisjointSet components;
+    components.resize(static_cast<unsigned int>(componentOffsets[tiles]));
+    DisjointSetStatistics statistics;
+
+    if (max != 0) {
+        visitRandomOrder(borders, generator, [&](auto &order) {
+            for (uint64_t i = 0; i < borders && connections != max && !_progress->isCancelled(); i++) {
+                if (connectTileBorder(order.next(), tilesX, sides.data(), true, componentOffsets, components, statistics)) {
+                    _progress->update(++connections);
+                }
+            }
+        });
+
+        visitRandomOrder(borders + doorOffsets[tiles], generator, [&](auto &order) {
+            while (connections != max && !_progress->isCancelled()) {
+                const uint64_t index = order.next();
+                if (index < borders ? connectTileBorder(index, tilesX, sides.data(), false, componentOffsets, components, statistics)
+                                    : connectTileDoor(index - borders, tilesX, forests, doorOffsets, componentOffsets, components, statistics)) {
+                    _progress->update(++connections);
+                }
+            }
+        });
+    }
+
+    _set.addStatistics(statistics);
+
+    if (_progress->isCancelled()) {
+        return;
+    }
+
+    _progress->finish();
+
+    if (const uint64_t errors = errorCount(errorFactor); errors != 0) {
+        if constexpr (SAMPLES_LOOPS<Generator>) {
+            connectSampledErrors(errors, generator);
+        } else {
+            auto order = randomOrder(static_cast<uint32_t>(_size), generator);
+            connectErrors(static_cast<unsigned int>(errors), order);
+        }
+    }
+}
+
+Region Maze::tileRegion(const unsigned int tile, const unsigned int tilesX) const {
+    const unsigned int tileX = tile % tilesX, tileY = tile / tilesX;
+    return {
+        tileX * MAZE_TILE_SIZE, tileY * MAZE_TILE_SIZE,
+        std::min((tileX + 1) * MAZE_TILE_SIZE, _width), std::min((tileY + 1) * MAZE_TILE_SIZE, _height)
+    };
+}
+
+// Connects a tile as if everything outside of it were one cell, reached through the walls of the sides shared with other tiles.
+// Kruskal's algorithm then gives a forest of the tile in which each component has exactly one exit, like the restriction to
+// the tile of a spanning tree of the whole maze. The exits are only marked: the tiles are joined afterwards.
+// The disjoint sets of a tile only number its own cells, so they stay small whatever the size of the maze.
+template <typename Generator>
+void Maze::connectTile(const unsigned int tile, const unsigned int tilesX, const unsigned int tilesY, Generator &generator, TileForest &forest, uint16_t *sides, DisjointSetStatistics &statistics) {
+    const Region region = tileRegion(tile, tilesX);
+    for (unsigned int y = region.top; y < region.bottom; y++) {
+        for (unsigned int x = region.left; x < region.right; x++) {
+            shuffleDirectionCombination(static_cast<size_t>(y) * _width + x, generator);
+        }
+    }
+
+    const unsigned int regionWidth = region.right - region.left, regionHeight = region.bottom - region.top;
+    const unsigned int area = regionWidth * regionHeight;
+    const unsigned int tileX = tile % tilesX, tileY = tile / tilesX;
+    const bool shared[] = {tileY != 0, tileY + 1 != tilesY, tileX != 0, tileX + 1 != tilesX};
+    const bool outside = shared[UP] || shared[DOWN] || shared[LEFT] || shared[RIGHT];
+
+    // Joining the outside is tracked per component instead of with an extra set: two components which both have their exit
+    // are already connected through the outside. The exits of the cells are kept by direction.
+    DisjointSet set;
+    set.resize(area);
+    std::vector<uint8_t> exited(area), exits(area);
+    unsigned int pending = area;
+    const auto join = [&](const unsigned int a, const unsigned int b, const Direction direction) {
+        const unsigned int rootA = set.find(a, statistics);
+        if (b == OUTSIDE_CELL) {
+            if (!shared[direction] || exited[rootA]) {
+                return false;
+            }
+            exited[rootA] = 1;
+            exits[a] |= 1 << direction;
+            pending--;
+            return true;
+        }
+
+        const unsigned int rootB = set.find(b, statistics);
+        if (rootA == rootB || (exited[rootA] && exited[rootB])) {
+            return false;
+        }
+        exited[set.link(rootA, rootB)] = exited[rootA] | exited[rootB];
+        pending--;
+        return true;
+    };
+
+    // A tile without shared side is the whole maze and is connected into a single component.
+    const unsigned int last = outside ? 0 : 1;
+    unsigned int connections = 0;
+    auto order = randomOrder(area, generator);
+
+    while (pending != last) {
+        if (tryConnect(order.next(), region, join)) {
+            if (++connections % MAZE_TILE_SIZE == 0 && _progress->isCancelled()) {
+                return;
+            }
+        }
+    }
+
+    // Components are numbered in the order of their first cell.
+    std::vector<uint16_t> labels(area, UINT16_MAX), components(area);
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < area; i++) {
+        uint16_t &label = labels[set.find(i, statistics)];
+        if (label == UINT16_MAX) {
+            label = static_cast<uint16_t>(count++);
+        }
+        components[i] = label;
+    }
+
+    const auto side = [&](const unsigned int i, const Direction direction) {
+        return static_cast<uint16_t>(components[i] | (exits[i] >> direction & 1 ? TILE_EXIT : 0));
+    };
+    for (unsigned int y = 0; y < regionHeight; y++) {
+        sides[LEFT_SIDE * MAZE_TILE_SIZE + y] = side(y * regionWidth, LEFT);
+        sides[RIGHT_SIDE * MAZE_TILE_SIZE + y] = side(y * regionWidth + regionWidth - 1, RIGHT);
+    }
+    for (unsigned int x = 0; x < regionWidth; x++) {
+        sides[TOP_SIDE * MAZE_TILE_SIZE + x] = side(x, UP);
+        sides[BOTTOM_SIDE * MAZE_TILE_SIZE + x] = side((regionHeight - 1) * regionWidth + x, DOWN);
+    }
+
+    // The door of two components is drawn uniformly among the walls between them, which are all closed.
+    std::unordered_map<uint32_t, uint32_t> pairs;
+    std::vector<uint32_t> counts;
+    forest.components = count;
+    forest.doors.clear();
+    const auto addWall = [&](const uint32_t wall, uint16_t a, uint16_t b) {
+        if (a > b) {
+            std::swap(a, b);
+        }
+        const auto [entry, inserted] = pairs.try_emplace(static_cast<uint32_t>(a) << 16 | b, static_cast<uint32_t>(counts.size()));
+        if (inserted) {
+            forest.doors.push_back({wall, a, b});
+            counts.push_back(1);
+        } else if (randomBelow(generator, ++counts[entry->second]) == 0) {
+            forest.doors[entry->second].wall = wall;
+        }
+    };
+
+    for (unsigned int i = 0; i < area; i++) {
+        if (i % regionWidth != regionWidth - 1 && components[i] != components[i + 1]) {
+            addWall(i * 2, components[i], components[i + 1]);
+        }
+        if (i + regionWidth < area && components[i] != components[i + regionWidth]) {
+            addWall(i * 2 + 1, components[i], components[i + regionWidth]);
+        }
+    }
+
+}
+
+// When exits is set, only the walls which are the exit of a component on either side are opened.
+bool Maze::connectTileBorder(uint64_t index, const unsigned int tilesX, const uint16_t *sides, const bool exits, const std::vector<uint64_t> &componentOffsets, DisjointSet &components, DisjointSetStatistics &statistics) {
+    const uint64_t verticalBorders = static_cast<uint64_t>((_width - 1) / MAZE_TILE_SIZE) * _height;
+    const bool vertical = index < verticalBorders;
+    unsigned int x, y, tile, neighbor;
+    uint16_t a, b;
+    if (vertical) {
+        x = static_cast<unsigned int>((index / _height + 1) * MAZE_TILE_SIZE - 1), y = static_cast<unsigned int>(index % _height);
+        tile = y / MAZE_TILE_SIZE * tilesX + x / MAZE_TILE_SIZE, neighbor = tile + 1;
+        a = sides[sideIndex(tile, RIGHT_SIDE, y % MAZE_TILE_SIZE)], b = sides[sideIndex(neighbor, LEFT_SIDE, y % MAZE_TILE_SIZE)];
+    } else {
+        index -= verticalBorders;
+        x = static_cast<unsigned int>(index % _width), y = static_cast<unsigned int>((index / _width + 1) * MAZE_TILE_SIZE - 1);
+        tile = y / MAZE_TILE_SIZE * tilesX + x / MAZE_TILE_SIZE, neighbor = tile + tilesX;
+        a = sides[sideIndex(tile, BOTTOM_SIDE, x % MAZE_TILE_SIZE)], b = sides[sideIndex(neighbor, TOP_SIDE, x % MAZE_TILE_SIZE)];
+    }
+
+    if (exits && !((a | b) & TILE_EXIT)) {
+        return false;
+    }
+    const uint64_t componentA = componentOffsets[tile] + (a & ~TILE_EXIT), componentB = componentOffsets[neighbor] + (b & ~TILE_EXIT);
+    if (!components.unite(static_cast<unsigned int>(componentA), static_cast<unsigned int>(componentB), statistics)) {
+        return false;
+    }
+    if (vertical) {
+        connectRight(x, y);
+    } else {
+        connectDown(x, y);
+    }
+    return true;
+}
+
+bool Maze::connectTileDoor(const uint64_t index, const unsigned int tilesX, const std::vector<TileForest> &forests, const std::vector<uint64_t> &doorOffsets,
+                           const std::vector<uint64_t> &componentOffsets, DisjointSet &components, DisjointSetStatistics &statistics) {
+    const auto tile = static_cast<unsigned int>(std::ranges::upper_bound(doorOffsets, index) - doorOffsets.begin() - 1);
+    const TileDoor &door = forests[tile].doors[index - doorOffsets[tile]];
+    const uint64_t a = componentOffsets[tile] + door.a, b = componentOffsets[tile] + door.b;
+    if (!components.unite(static_cast<unsigned int>(a), static_cast<unsigned int>(b), statistics)) {
+        return false;
+    }
+
+    const Region region = tileRegion(tile, tilesX);
+    const unsigned int regionWidth = region.right - region.left, cell = door.wall >> 1;
+    const unsigned int x = region.left + cell % regionWidth, y = region.top + cell / regionWidth;
+    if (door.wall & 1) {
+        connectDown(x, y);
+    } else {
+        connectRight(x, y);
+    }
+    return true;
+}
+
+uint64_t Maze::errorCount(const double errorFactor) const {
+    return std::llround(static_cast<double>(_size - _width - _height + 1) * errorFactor);
+}
+
+void Maze::checkIndexedSize(const std::string &what) const {
+    if (_size > MAZE_MAX_INDEXED_CELLS) {
+        throw std::length_error(what + " is limited to " + std::to_string(MAZE_MAX_INDEXED_CELLS) + " cells");
+    }
+}
+
+template <typename Order>
+void Maze::connectErrors(const unsigned int errors, Order &order) {
     for (unsigned int i = 0; i < _size; i++) {
-        _points[i].resetDirectionIndex();
-        update(i / static_cast<double>(_size));
+        resetDirectionIndex(i);
     }
 
-    forceUpdate(0);
+    _progress->start(ERRORS, errors);
 
-    connections = 0;
-    queue.reset();
+    unsigned int connections = 0;
 
-    while (connections != errors && !isCancelled()) {
-        if (queue.next()->forceConnect()) {
-            update(++connections / static_cast<double>(errors));
+    while (connections != errors && !_progress->isCancelled()) {
+        if (forceConnect(order.next())) {
+            _progress->update(++connections);
         }
     }
 
-    if (isCancelled()) {
+    if (_progress->isCancelled()) {
         return;
     }
 
-    forceUpdate(1);
+    _progress->finish();
 }
 
-QBitmap Maze::generateImage(const int pathSize, const int wallSize) {
-    forceUpdate(0);
+// Draws the loops as a uniform sample of the closed interior walls, with no rejected draw whatever the error factor.
+// The closed walls are ranked in reading order, then Floyd's algorithm marks a sample of ranks in a bit set
+// with one draw per sampled wall. Above half of the walls, the walls left closed are drawn instead.
+// Only the bit set is allocated, one bit per closed wall: the ranks are counted again while the sample is deposited.
+template <typename Generator>
+void Maze::connectSampledErrors(const uint64_t errors, Generator &generator) {
+    const size_t words = 2 * static_cast<size_t>(_stride) * _height;
+    uint64_t closed = 0;
+    for (size_t word = 0; word < words; word++) {
+        closed += std::popcount(closedWalls(word));
+    }
 
-    QBitmap image(static_cast<int>(_width * pathSize + (_width + 1) * wallSize), static_cast<int>(_height * pathSize + (_height + 1) * wallSize));
-    image.fill(Qt::black);
+    const bool complement = errors > closed / 2;
+    const uint64_t count = complement ? closed - errors : errors;
 
-    QPainter painter(&image);
-    painter.setPen(Qt::NoPen);
-    painter.setBrush(Qt::white);
+    ZeroedArray<uint64_t> sample(closed / 64 + 2);
+    for (uint64_t j = closed - count; j < closed; j++) {
+        const uint64_t rank = randomBelow64(generator, j + 1);
+        const uint64_t chosen = sample[rank >> 6] >> (rank & 63) & 1 ? j : rank;
+        sample[chosen >> 6] |= uint64_t{1} << (chosen & 63);
+    }
 
-    unsigned int pos = 0;
-    int imgY = wallSize;
-    for (int y = 0; y < _height; y++) {
-        int imgX = wallSize;
-        for (int x = 0; x < _width; x++) {
-            const Point p = _points[pos];
+    _progress->start(ERRORS, errors);
 
-            painter.drawRect(imgX, imgY, pathSize, pathSize);
-            if (p._connectedRight) {
-                painter.drawRect(imgX + pathSize, imgY, wallSize, pathSize);
-            }
-            if (p._connectedDown) {
-                painter.drawRect(imgX, imgY + pathSize, pathSize, wallSize);
+    // The sampled ranks of a word are then deposited on its closed walls, in order.
+    uint64_t opened = 0, first = 0;
+    for (size_t word = 0; word < words && !_progress->isCancelled(); word++) {
+        const uint64_t walls = closedWalls(word);
+        const auto length = static_cast<unsigned int>(std::popcount(walls));
+        if (length == 0) {
+            continue;
+        }
+
+        const auto shift = static_cast<unsigned int>(first & 63);
+        uint64_t chosen = sample[first >> 6] >> shift;
+        if (shift != 0) {
+            chosen |= sample[(first >> 6) + 1] << (64 - shift);
+        }
+        if (length != 64) {
+            chosen &= (uint64_t{1} << length) - 1;
+        }
+
+        uint64_t selected = 0;
+        uint64_t remaining = walls;
+        for (; chosen != 0; chosen >>= 1, remaining &= remaining - 1) {
+            if (chosen & 1) {
+                selected |= uint64_t{1} << std::countr_zero(remaining);
             }
+        }
 
-            update(++pos / static_cast<double>(_size));
-            imgX += pathSize + wallSize;
+        first += length;
+
+        const uint64_t open = complement ? walls & ~selected : selected;
+        if (open != 0) {
+            openWalls(word, open);
+            opened += std::popcount(open);
+            _progress->update(opened);
         }
-        imgY += pathSize + wallSize;
     }
 
-    forceUpdate(1);
+    if (_progress->isCancelled()) {
+        return;
+    }
+
+    _progress->finish();
+}
+
+// Even words hold the right walls of 64 cells of a row, odd words their down walls.
+// The walls of the last column and of the last row are borders and never open.
+uint64_t Maze::closedWalls(const size_t word) const {
+    const size_t index = word >> 1;
+    const auto y = static_cast<unsigned int>(index / _stride), first = static_cast<unsigned int>(index % _stride) * 64;
+    unsigned int walls;
+    uint64_t connected;
+    if (word & 1) {
+        walls = y == _height - 1 ? 0 : _width;
+        connected = _down[index];
+    } else {
+        walls = _width - 1;
+        connected = _right[index];
+    }
 
-    return image;
+    if (walls <= first) {
+        return 0;
+    }
+    const uint64_t interior = walls - first >= 64 ? ~uint64_t{0} : (uint64_t{1} << (walls - first)) - 1;
+    return ~connected & interior;
 }
 
-void Maze::update(const double progress) {
-    if (const int value = std::lround(progress * WORKER_MAX_PROGRESS); _lastUpdate != value) {
-        forceIntUpdate(value);
+void Maze::openWalls(const size_t word, const uint64_t walls) {
+    if (word & 1) {
+        _down[word >> 1] |= walls;
+    } else {
+        _right[word >> 1] |= walls;
     }
 }
 
-void Maze::forceUpdate(const double progress) {
-    forceIntUpdate(std::lround(progress * WORKER_MAX_PROGRESS));
+QImage Maze::generateImage(const int pathSize, const int wallSize) {
+    ImageSink sink(pixelSize(_width, pathSize, wallSize), pixelSize(_height, pathSize, wallSize));
+    generateImage(pathSize, wallSize, sink);
+    return sink.finish();
 }
 
-void Maze::forceIntUpdate(const int progress) {
-    _lastUpdate = progress;
-    if (_worker != nullptr) {
-        emit _worker->progress(progress);
+// The image is split in horizontal bands of cell rows rendered concurrently.
+// Bands are rendered in batches and then handed to the sink in order.
+void Maze::generateImage(const int pathSize, const int wallSize, ScanlineSink &sink, const int threads) {
+    _right.advise(SEQUENTIAL_ACCESS);
+    _down.advise(SEQUENTIAL_ACCESS);
+
+    _progress->start(RENDERING, _height);
+
+    const size_t lineSize = (pixelSize(_width, pathSize, wallSize) + 7) / 8;
+    const auto bandRows = static_cast<unsigned int>(std::max<size_t>(MAZE_BAND_BYTES / (2 * lineSize), 1));
+    const unsigned int bands = (_height + bandRows - 1) / bandRows;
+    const unsigned int batchSize = std::min(2 * static_cast<unsigned int>(threadCount(threads)), bands);
+
+    std::vector blocks(batchSize, ScanlineBlock(lineSize));
+
+    for (unsigned int batch = 0; batch < bands && !_progress->isCancelled(); batch += batchSize) {
+        const unsigned int count = std::min(batchSize, bands - batch);
+
+        parallelFor(count, threads, [&](const unsigned int index) {
+            const unsigned int band = batch + index;
+            ScanlineBlock &block = blocks[index];
+            block.clear();
+
+            Renderer renderer(_width, pathSize, wallSize, block);
+            if (band == 0) {
+                renderer.renderTop();
+            }
+
+            const unsigned int end = std::min((band + 1) * bandRows, _height);
+            for (unsigned int y = band * bandRows; y < end; y++) {
+                const size_t offset = static_cast<size_t>(y) * _stride;
+                renderer.renderRow(_right.data() + offset, _down.data() + offset);
+            }
+            _progress->add(end - band * bandRows);
+        });
+
+        sink.writeBlocks(blocks, count);
     }
 }
 
-bool Maze::isCancelled() const {
-    return _worker != nullptr && _worker->isCancelled();
+
+const DisjointSetStatistics& Maze::connectStatistics() const {
+    return _set.statistics();
+}
+
+uint64_t Maze::fingerprint() const {
+    Fingerprint fingerprint(_width, _height);
+    for (unsigned int y = 0; y < _height; y++) {
+        const size_t offset = static_cast<size_t>(y) * _stride;
+        fingerprint.addRow(_right.data() + offset, _down.data() + offset, _stride);
+    }
+    return fingerprint.value();
 }
 
-Point::Point(Maze &maze, const unsigned int position) : _maze(maze), _position(position) {}
+bool Maze::save(const QString &fileName, const MazeFileInfo &info, const int compressionLevel, const int threads) const {
+    MazeFileInfo header = info;
+    header.width = _width;
+    header.height = _height;
 
-bool Point::append(Point& other) {
-    Point *a = top(), *b = other.top();
-    if (a == b) {
+    MazeFileWriter writer(fileName, compressionLevel, threads);
+    if (!writer.open(header)) {
         return false;
     }
-    a->_parent = b;
-    return true;
+    for (unsigned int y = 0; y < _height; y++) {
+        const size_t offset = static_cast<size_t>(y) * _stride;
+        writer.addRow(_right.data() + offset, _down.data() + offset);
+    }
+    return writer.finish();
 }
 
-Point* Point::top() {
-    if (_parent == nullptr) {
-        return this;
+// Tiles are aligned on words, so they are decoded concurrently straight into the wall grids.
+std::unique_ptr<Maze> Maze::load(const QString &fileName, MazeFileInfo &info, const int threads) {
+    MazeFile file(fileName);
+    if (!file.open()) {
+        return nullptr;
     }
-    Point* t = _parent->top();
-    _parent = t;
-    return t;
+    info = file.info();
+
+    auto maze = std::make_unique<Maze>(info.width, info.height);
+    maze->fill();
+
+    const unsigned int tilesX = (info.width + MAZE_FILE_TILE_SIZE - 1) / MAZE_FILE_TILE_SIZE, tilesY = (info.height + MAZE_FILE_TILE_SIZE - 1) / MAZE_FILE_TILE_SIZE;
+    std::atomic<bool> failed{false};
+
+    parallelFor(tilesX * tilesY, threads, [&](const unsigned int tile) {
+        const unsigned int tileX = tile % tilesX, tileY = tile / tilesX;
+        const Region region = {
+            tileX * MAZE_FILE_TILE_SIZE, tileY * MAZE_FILE_TILE_SIZE,
+            std::min((tileX + 1) * MAZE_FILE_TILE_SIZE, info.width), std::min((tileY + 1) * MAZE_FILE_TILE_SIZE, info.height)
+        };
+        const size_t offset = static_cast<size_t>(region.top) * maze->_stride + region.left / 64;
+        if (!file.readRegion(region, maze->_right.data() + offset, maze->_down.data() + offset, maze->_stride)) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+    });
+
+    return failed.load(std::memory_order_relaxed) ? nullptr : std::move(maze);
 }
 
-void Point::shuffleDirectionCombination(std::mt19937 &generator) {
-    _directions = &randomDirectionCombination(generator);
-    resetDirectionIndex();
+template <typename Generator>
+void Maze::shuffleDirectionCombination(const size_t position, Generator &generator) {
+    _directions[position] = randomDirectionCombinationIndex(generator);
 }
 
-void Point::resetDirectionIndex() {
-    _directionIndex = -1;
+void Maze::advise(const ArenaAccess access) {
+    _set.advise(access);
+    _right.advise(access);
+    _down.advise(access);
+    _directions.advise(access);
 }
 
-bool Point::tryConnect() {
-    while (_directionIndex < 3) {
-        _directionIndex++;
-        if (tryConnect((*_directions)[_directionIndex])) {
+void Maze::resetDirectionIndex(const unsigned int position) {
+    _directions[position] &= DIRECTION_COMBINATION_MASK;
+}
+
+template <typename Join>
+bool Maze::tryConnect(const unsigned int index, const Region &region, Join &join) {
+    const unsigned int regionWidth = region.right - region.left;
+    const unsigned int y = region.top + index / regionWidth, x = region.left + index % regionWidth;
+    uint8_t &state = _directions[static_cast<size_t>(y) * _width + x];
+    const DirectionCombination &directions = directionCombination(state & DIRECTION_COMBINATION_MASK);
+
+    int cursor = state >> DIRECTION_INDEX_SHIFT;
+    while (cursor < 4) {
+        if (tryConnect(index, x, y, directions[cursor++], region, join)) {
+            state = (state & DIRECTION_COMBINATION_MASK) | cursor << DIRECTION_INDEX_SHIFT;
             return true;
         }
     }
+    state = (state & DIRECTION_COMBINATION_MASK) | cursor << DIRECTION_INDEX_SHIFT;
     return false;
 }
 
-bool Point::tryConnect(const Direction direction) {
-    unsigned int rel;
+template <typename Join>
+bool Maze::tryConnect(const unsigned int index, const unsigned int x, const unsigned int y, const Direction direction, const Region &region, Join &join) {
+    const unsigned int regionWidth = region.right - region.left;
     switch (direction) {
         case UP:
-            rel = _position - _maze._width;
-            if (rel > _position) { // underflow
-                return false;
+            if (y == region.top) {
+                return join(index, OUTSIDE_CELL, direction);
             }
-
-        {
-            Point& p = _maze._points[rel];
-            if (!append(p)) {
+            if (!join(index, index - regionWidth, direction)) {
                 return false;
             }
-
-            p._connectedDown = true;
-        }
+            connectDown(x, y - 1);
             return true;
         case DOWN:
-            rel = _position + _maze._width;
-            if (rel >= _maze._size) {
-                return false;
+            if (y == region.bottom - 1) {
+                return join(index, OUTSIDE_CELL, direction);
             }
-
-            if (!append(_maze._points[rel])) {
+            if (!join(index, index + regionWidth, direction)) {
                 return false;
             }
-
-            _connectedDown = true;
+            connectDown(x, y);
             return true;
         case LEFT:
-            if (_position % _maze._width == 0) {
-                return false;
+            if (x == region.left) {
+                return join(index, OUTSIDE_CELL, direction);
             }
-
-        {
-            Point& p = _maze._points[_position - 1];
-            if (!append(p)) {
+            if (!join(index, index - 1, direction)) {
                 return false;
             }
-
-            p._connectedRight = true;
-        }
+            connectRight(x - 1, y);
             return true;
         case RIGHT:
-            rel = _position + 1;
-            if (rel % _maze._width == 0) {
-                return false;
+            if (x == region.right - 1) {
+                return join(index, OUTSIDE_CELL, direction);
             }
-
-            if (!append(_maze._points[rel])) {
+            if (!join(index, index + 1, direction)) {
                 return false;
             }
-
-            _connectedRight = true;
+            connectRight(x, y);
             return true;
     }
     throw std::invalid_argument("Invalid direction");
 }
 
-bool Point::forceConnect() {
-    while (_directionIndex < 3) {
-        _directionIndex++;
-        if (forceConnect((*_directions)[_directionIndex])) {
+bool Maze::forceConnect(const unsigned int position) {
+    const unsigned int y = position / _width, x = position % _width;
+    uint8_t &state = _directions[position];
+    const DirectionCombination &directions = directionCombination(state & DIRECTION_COMBINATION_MASK);
+
+    int index = state >> DIRECTION_INDEX_SHIFT;
+    while (index < 4) {
+        if (forceConnect(x, y, directions[index++])) {
+            state = (state & DIRECTION_COMBINATION_MASK) | index << DIRECTION_INDEX_SHIFT;
             return true;
         }
     }
+    state = (state & DIRECTION_COMBINATION_MASK) | index << DIRECTION_INDEX_SHIFT;
     return false;
 }
 
-bool Point::forceConnect(const Direction direction) {
-    unsigned int rel;
+bool Maze::forceConnect(const unsigned int x, const unsigned int y, const Direction direction) {
     switch (direction) {
         case UP:
-            rel = _position - _maze._width;
-            if (rel > _position) { // underflow
+            if (y == 0 || isConnectedDown(x, y - 1)) {
                 return false;
             }
-
-        {
-            Point& p = _maze._points[rel];
-            if (p._connectedDown) {
-                return false;
-            }
-
-            p._connectedDown = true;
-        }
+            connectDown(x, y - 1);
             return true;
         case DOWN:
-            rel = _position + _maze._width;
-            if (rel >= _maze._size) {
-                return false;
-            }
-
-            if (_connectedDown) {
+            if (y == _height - 1 || isConnectedDown(x, y)) {
                 return false;
             }
-
-            _connectedDown = true;
+            connectDown(x, y);
             return true;
         case LEFT:
-            if (_position % _maze._width == 0) {
-                return false;
-            }
-
-        {
-            Point& p = _maze._points[_position - 1];
-            if (p._connectedRight) {
+            if (x == 0 || isConnectedRight(x - 1, y)) {
                 return false;
             }
-
-            p._connectedRight = true;
-        }
+            connectRight(x - 1, y);
             return true;
         case RIGHT:
-            rel = _position + 1;
-            if (rel % _maze._width == 0) {
-                return false;
-            }
-
-            if (_connectedRight) {
+            if (x == _width - 1 || isConnectedRight(x, y)) {
                 return false;
             }
-
-            _connectedRight = true;
+            connectRight(x, y);
             return true;
     }
     throw std::invalid_argument("Invalid direction");
 }
+
+void Maze::connectRight(const unsigned int x, const unsigned int y) {
+    _right[static_cast<size_t>(y) * _stride + (x >> 6)] |= uint64_t{1} << (x & 63);
+}
+
+void Maze::connectDown(const unsigned int x, const unsigned int y) {
+    _down[static_cast<size_t>(y) * _stride + (x >> 6)] |= uint64_t{1} << (x & 63);
+}
+
+template void Maze::connectAll(std::mt19937 &generator, double errorFactor);
+template void Maze::connectAll(Xoshiro256 &generator, double errorFactor);
+template void Maze::connectAll(Pcg64 &generator, double errorFactor);
+template void Maze::connectAll(SplitMix64 &generator, double errorFactor);
+template void Maze::connectAll(LoopSampling<Xoshiro256> &generator, double errorFactor);
+template void Maze::connectAll(LoopSampling<Pcg64> &generator, double errorFactor);
+template void Maze::connectAll(LoopSampling<SplitMix64> &generator, double errorFactor);
+
+template void Maze::connectAllTiled(std::mt19937 &generator, double errorFactor, int threads);
+template void Maze::connectAllTiled(Xoshiro256 &generator, double errorFactor, int threads);
+template void Maze::connectAllTiled(Pcg64 &generator, double errorFactor, int threads);
+template void Maze::connectAllTiled(SplitMix64 &generator, double errorFactor, int threads);
+template void Maze::connectAllTiled(LoopSampling<Xoshiro256> &generator, double errorFactor, int threads);
+template void Maze::connectAllTiled(LoopSampling<Pcg64> &generator, double errorFactor, int threads);
+template void Maze::connectAllTiled(LoopSampling<SplitMix64> &generator, double errorFactor, int threads);
+
+template void Maze::connectSampledErrors(uint64_t errors, std::mt19937 &generator);
+template void Maze::connectSampledErrors(uint64_t errors, Xoshiro256 &generator);
+template void Maze::connectSampledErrors(uint64_t errors, Pcg64 &generator);
+template void Maze::connectSampledErrors(uint64_t errors, SplitMix64 &generator);
+template void Maze::connectSampledErrors(uint64_t errors, LoopSampling<Xoshiro256> &generator);
+template void Maze::connectSampledErrors(uint64_t errors, LoopSampling<Pcg64> &generator);
+template void Maze::connectSampledErrors(uint64_t errors, LoopSampling<SplitMix64> &generator);
@@ -23,77 +23,215 @@
 #ifndef MAZE_HPP
 #define MAZE_HPP
 
-#include <QBitmap>
+#include <QImage>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <random>
+#include <string>
+#include "arena.hpp"
 #include "direction.hpp"
-#include "worker.hpp"
+#include "disjoint_set.hpp"
+#include "engine.hpp"
+#include "progress.hpp"
+#include "random.hpp"
+#include "scanline.hpp"
 
-class Point;
+constexpr unsigned int MAZE_TILE_SIZE = 256;
+constexpr size_t MAZE_BAND_BYTES = 1 << 20;
 
-class Maze {
-    friend class Point;
+constexpr uint8_t DIRECTION_COMBINATION_MASK = 0x1F;
+constexpr int DIRECTION_INDEX_SHIFT = 5;
+
+// The classic, Wilson, Prim and backtracker engines, the loops of the v1 random algorithms, the path index and the analysis
+// number the cells on 32 bits. Larger mazes need the tiled, sidewinder or binary tree engine and a v2 random algorithm.
+constexpr uint64_t MAZE_MAX_INDEXED_CELLS = UINT32_MAX;
+
+// Whether a maze of this many cells can be connected with these parameters, see MAZE_MAX_INDEXED_CELLS.
+bool canConnect(Engine engine, RandomAlgorithm randomAlgorithm, double errorFactor, uint64_t cells);
+
+// Changes whenever the same parameters may produce a different maze.
+constexpr unsigned int MAZE_ALGORITHM_VERSION = 3;
+
+struct Region {
+    unsigned int left, top, right, bottom;
+};
 
+// The closed walls between two components of a tile, represented by one of them.
+struct TileDoor {
+    uint32_t wall;
+    uint16_t a, b;
+};
+
+struct TileForest {
+    unsigned int components;
+    std::vector<TileDoor> doors;
+};
+
+struct MazeFileInfo;
+
+class Maze {
     public:
 
     Maze(unsigned int width, unsigned int height);
 
     void fill();
 
-    void connectAll(std::mt19937 &generator, double errorFactor);
+    template <typename Generator>
+    void connectAll(Generator &generator, double errorFactor);
 
-    [[nodiscard]] QBitmap generateImage(int pathSize, int wallSize);
+    // Connects each tile of MAZE_TILE_SIZE cells as a forest in parallel, then joins the forests of all tiles into one maze.
+    template <typename Generator>
+    void connectAllTiled(Generator &generator, double errorFactor, int threads);
 
-    Worker *_worker;
+    // Connects the cells with any engine but the streaming one, which throws std::invalid_argument.
+    template <typename Generator>
+    void connect(Engine engine, Generator &generator, double errorFactor, int threads = 1);
 
-    private:
+    [[nodiscard]] QImage generateImage(int pathSize, int wallSize);
 
-    void update(double progress);
+    void generateImage(int pathSize, int wallSize, ScanlineSink &sink, int threads = 1);
 
-    void forceUpdate(double progress);
+    [[nodiscard]] bool isConnectedRight(unsigned int x, unsigned int y) const;
 
-    void forceIntUpdate(int progress);
+    [[nodiscard]] bool isConnectedDown(unsigned int x, unsigned int y) const;
 
-    bool isCancelled() const;
+    [[nodiscard]] unsigned int width() const;
 
-    unsigned int _width, _height, _size;
-    std::vector<Point> _points{};
-    int _lastUpdate;
-};
+    [[nodiscard]] unsigned int height() const;
 
-class Point {
-    friend class Maze;
+    // Number of cells, which may exceed 32 bits.
+    [[nodiscard]] uint64_t size() const;
 
-    public:
+    // Connections of a row of cells, one bit per cell.
+    [[nodiscard]] const uint64_t* rightRow(unsigned int y) const;
+
+    [[nodiscard]] const uint64_t* downRow(unsigned int y) const;
+
+    [[nodiscard]] const DisjointSetStatistics& connectStatistics() const;
+
+    [[nodiscard]] uint64_t fingerprint() const;
 
-    Point(Maze& maze, unsigned int position);
+    // Number of loops added to the spanning tree by connectAll and connectAllTiled.
+    [[nodiscard]] uint64_t errorCount(double errorFactor) const;
+
+    // The dimensions of the info are replaced by those of the maze.
+    bool save(const QString &fileName, const MazeFileInfo &info, int compressionLevel = 6, int threads = 1) const;
+
+    // Only the walls are loaded: the maze can be rendered but not connected again.
+    [[nodiscard]] static std::unique_ptr<Maze> load(const QString &fileName, MazeFileInfo &info, int threads = 1);
+
+    std::shared_ptr<Progress> _progress;
 
     private:
 
-    Maze& _maze;
-    unsigned int _position;
+    [[nodiscard]] Region tileRegion(unsigned int tile, unsigned int tilesX) const;
+
+    template <typename Generator>
+    void connectTile(unsigned int tile, unsigned int tilesX, unsigned int tilesY, Generator &generator, TileForest &forest, uint16_t *sides, DisjointSetStatistics &statistics);
+
+    bool connectTileBorder(uint64_t index, unsigned int tilesX, const uint16_t *sides, bool exits, const std::vector<uint64_t> &componentOffsets, DisjointSet &components, DisjointSetStatistics &statistics);
 
-    Point* _parent = nullptr;
-    bool _connectedRight = false, _connectedDown = false;
+    bool connectTileDoor(uint64_t index, unsigned int tilesX, const std::vector<TileForest> &forests, const std::vector<uint64_t> &doorOffsets,
+                         const std::vector<uint64_t> &componentOffsets, DisjointSet &components, DisjointSetStatistics &statistics);
 
-    DirectionCombination const* _directions = &DIRECTIONS;
-    short _directionIndex = 0;
+    template <typename Order>
+    void connectErrors(unsigned int errors, Order &order);
 
-    bool append(Point& other);
+    template <typename Generator>
+    void connectSampledErrors(uint64_t errors, Generator &generator);
 
-    Point* top();
+    // Throws std::length_error when the cells cannot be numbered on 32 bits.
+    void checkIndexedSize(const std::string &what) const;
 
-    void shuffleDirectionCombination(std::mt19937 &generator);
+    template <typename Generator>
+    void connectWilson(Generator &generator);
 
-    void resetDirectionIndex();
+    template <typename Generator>
+    void connectPrim(Generator &generator);
 
-    bool tryConnect();
+    template <typename Generator>
+    void connectBacktracker(Generator &generator);
 
-    bool tryConnect(Direction direction);
+    template <typename Generator>
+    void connectSidewinder(Generator &generator, int threads);
 
-    bool forceConnect();
+    template <typename Generator>
+    void connectBinaryTree(Generator &generator, int threads);
 
-    bool forceConnect(Direction direction);
+    [[nodiscard]] bool isInterior(unsigned int x, unsigned int y) const;
+
+    template <typename Interior>
+    [[nodiscard]] bool hasNeighbor(unsigned int x, unsigned int y, Direction direction) const;
+
+    [[nodiscard]] unsigned int neighbor(unsigned int position, Direction direction) const;
+
+    void openWall(unsigned int position, Direction direction);
+
+    [[nodiscard]] uint64_t closedWalls(size_t word) const;
+
+    void openWalls(size_t word, uint64_t walls);
+
+    template <typename Generator>
+    void shuffleDirectionCombination(size_t position, Generator &generator);
+
+    void resetDirectionIndex(unsigned int position);
+
+    void advise(ArenaAccess access);
+
+    // The index numbers the cells of the region, in which the join function unites two cells and tells whether it did.
+    template <typename Join>
+    bool tryConnect(unsigned int index, const Region &region, Join &join);
+
+    template <typename Join>
+    bool tryConnect(unsigned int index, unsigned int x, unsigned int y, Direction direction, const Region &region, Join &join);
+
+    bool forceConnect(unsigned int position);
+
+    bool forceConnect(unsigned int x, unsigned int y, Direction direction);
+
+    void connectRight(unsigned int x, unsigned int y);
+
+    void connectDown(unsigned int x, unsigned int y);
+
+    unsigned int _width, _height;
+    uint64_t _size;
+
+    // Cells are stored as separate zero-initialized arrays instead of one object per cell:
+    // the disjoint set of connected cells, only allocated by the classic engine, a row-aligned bit grid for each of the right
+    // and down connections, and one byte per cell packing the direction combination (low 5 bits) and the direction cursor (high 3 bits).
+    DisjointSet _set{};
+    unsigned int _stride;
+    ZeroedArray<uint64_t> _right{}, _down{};
+    ZeroedArray<uint8_t> _directions{};
 };
 
+inline bool Maze::isConnectedRight(const unsigned int x, const unsigned int y) const {
+    return _right[static_cast<size_t>(y) * _stride + (x >> 6)] >> (x & 63) & 1;
+}
+
+inline bool Maze::isConnectedDown(const unsigned int x, const unsigned int y) const {
+    return _down[static_cast<size_t>(y) * _stride + (x >> 6)] >> (x & 63) & 1;
+}
+
+inline unsigned int Maze::width() const {
+    return _width;
+}
+
+inline unsigned int Maze::height() const {
+    return _height;
+}
+
+inline uint64_t Maze::size() const {
+    return _size;
+}
+
+inline const uint64_t* Maze::rightRow(const unsigned int y) const {
+    return _right.data() + static_cast<size_t>(y) * _stride;
+}
+
+inline const uint64_t* Maze::downRow(const unsigned int y) const {
+    return _down.data() + static_cast<size_t>(y) * _stride;
+}
+
 #endif //MAZE_HPP
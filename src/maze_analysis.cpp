@@ -0,0 +1,284 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "maze_analysis.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "parallel.hpp"
+
+constexpr unsigned int ANALYSIS_BAND_ROWS = 64;
+constexpr size_t ANALYSIS_FRONTIER_CHUNK = 1 << 14;
+
+uint64_t MazeAnalysis::deadEnds() const {
+    return degrees[1];
+}
+
+uint64_t MazeAnalysis::junctions() const {
+    return degrees[3] + degrees[4];
+}
+
+bool MazeAnalysis::isConnected() const {
+    return components == 1;
+}
+
+bool MazeAnalysis::isPerfect() const {
+    return components == 1 && loops == 0;
+}
+
+bool MazeAnalysis::isValid(const uint64_t errors) const {
+    return components == 1 && loops == errors;
+}
+
+namespace {
+
+class Analyzer {
+    public:
+
+    explicit Analyzer(const Maze &maze) : _maze(maze), _width(maze.width()), _height(maze.height()) {}
+
+    void scan(MazeAnalysis &analysis, int threads) const;
+
+    void search(MazeAnalysis &analysis, int threads) const;
+
+    private:
+
+    unsigned int step(unsigned int cell, unsigned int previous, unsigned int &next) const;
+
+    [[nodiscard]] unsigned int corridorLength(unsigned int cell, unsigned int next) const;
+
+    void scanRow(unsigned int y, std::array<uint64_t, 5> &degrees, uint64_t &connections, std::vector<uint64_t> &lengths) const;
+
+    unsigned int breadthFirst(unsigned int start, ZeroedArray<uint32_t> &distances, unsigned int &distance, uint64_t &reached, int threads) const;
+
+    template <typename Visit>
+    void forEachNeighbor(unsigned int cell, const Visit &visit) const;
+
+    const Maze &_maze;
+    const unsigned int _width, _height;
+};
+
+template <typename Visit>
+void Analyzer::forEachNeighbor(const unsigned int cell, const Visit &visit) const {
+    const unsigned int x = cell % _width, y = cell / _width;
+    if (x != 0 && _maze.isConnectedRight(x - 1, y)) {
+        visit(cell - 1);
+    }
+    if (x + 1 != _width && _maze.isConnectedRight(x, y)) {
+        visit(cell + 1);
+    }
+    if (y != 0 && _maze.isConnectedDown(x, y - 1)) {
+        visit(cell - _width);
+    }
+    if (y + 1 != _height && _maze.isConnectedDown(x, y)) {
+        visit(cell + _width);
+    }
+}
+
+// Number of connections of a cell, and its last connected neighbor other than the previous cell.
+unsigned int Analyzer::step(const unsigned int cell, const unsigned int previous, unsigned int &next) const {
+    unsigned int count = 0;
+    forEachNeighbor(cell, [&](const unsigned int neighbor) {
+        count++;
+        if (neighbor != previous) {
+            next = neighbor;
+        }
+    });
+    return count;
+}
+
+unsigned int Analyzer::corridorLength(unsigned int cell, unsigned int next) const {
+    unsigned int length = 1, following;
+    while (step(next, cell, following) == 2) {
+        cell = next;
+        next = following;
+        length++;
+    }
+    return length;
+}
+
+// Each bit of the four masks is one connection of a cell. They are added as bit vectors, 64 cells at a time,
+// into the three bits of the degree: low, high and four.
+// Corridors are walked from both of their ends, the cells of an odd degree or four, so every length is counted twice.
+void Analyzer::scanRow(const unsigned int y, std::array<uint64_t, 5> &degrees, uint64_t &connections, std::vector<uint64_t> &lengths) const {
+    const unsigned int words = (_width + 63) / 64;
+    const uint64_t *right = _maze.rightRow(y), *down = _maze.downRow(y), *up = y == 0 ? nullptr : _maze.downRow(y - 1);
+
+    for (unsigned int i = 0; i < words; i++) {
+        const uint64_t r = right[i], d = down[i], u = up == nullptr ? 0 : up[i];
+        const uint64_t l = r << 1 | (i == 0 ? 0 : right[i - 1] >> 63);
+        const uint64_t valid = i == words - 1 && _width % 64 != 0 ? (uint64_t{1} << _width % 64) - 1 : ~uint64_t{0};
+
+        const uint64_t sum1 = r ^ l, carry1 = r & l, sum2 = d ^ u, carry2 = d & u;
+        const uint64_t low = sum1 ^ sum2, carry = sum1 & sum2;
+        const uint64_t high = carry1 ^ carry2 ^ carry, four = carry1 & carry2;
+
+        connections += std::popcount(r) + std::popcount(d);
+        degrees[0] += std::popcount(~low & ~high & ~four & valid);
+        degrees[1] += std::popcount(low & ~high);
+        degrees[2] += std::popcount(~low & high);
+        degrees[3] += std::popcount(low & high);
+        degrees[4] += std::popcount(four);
+
+        for (uint64_t ends = low | four; ends != 0; ends &= ends - 1) {
+            const unsigned int cell = y * _width + i * 64 + std::countr_zero(ends);
+            forEachNeighbor(cell, [&](const unsigned int next) {
+                const unsigned int length = corridorLength(cell, next);
+                if (length >= lengths.size()) {
+                    lengths.resize(length + 1);
+                }
+                lengths[length]++;
+            });
+        }
+    }
+}
+
+void Analyzer::scan(MazeAnalysis &analysis, const int threads) const {
+    std::mutex mutex;
+    const unsigned int bands = (_height + ANALYSIS_BAND_ROWS - 1) / ANALYSIS_BAND_ROWS;
+
+    parallelFor(bands, threads, [&](const unsigned int band) {
+        std::array<uint64_t, 5> degrees{};
+        uint64_t connections = 0;
+        std::vector<uint64_t> lengths;
+
+        const unsigned int last = std::min((band + 1) * ANALYSIS_BAND_ROWS, _height);
+        for (unsigned int y = band * ANALYSIS_BAND_ROWS; y < last; y++) {
+            scanRow(y, degrees, connections, lengths);
+        }
+
+        const std::lock_guard lock(mutex);
+        analysis.connections += connections;
+        for (size_t i = 0; i < degrees.size(); i++) {
+            analysis.degrees[i] += degrees[i];
+        }
+        if (lengths.size() > analysis.corridorLengths.size()) {
+            analysis.corridorLengths.resize(lengths.size());
+        }
+        for (size_t i = 0; i < lengths.size(); i++) {
+            analysis.corridorLengths[i] += lengths[i];
+        }
+    });
+
+    for (uint64_t &count : analysis.corridorLengths) {
+        count /= 2;
+    }
+}
+
+// Level by level. Distances are stored plus one so that zero marks an unvisited cell,
+// and cells are claimed atomically when a large frontier is expanded by several threads.
+// Returns the first cell of the last level.
+unsigned int Analyzer::breadthFirst(const unsigned int start, ZeroedArray<uint32_t> &distances, unsigned int &distance, uint64_t &reached, const int threads) const {
+    std::vector<uint32_t> frontier{start}, next;
+    distances[start] = 1;
+    distance = 0;
+    reached = 1;
+
+    for (;;) {
+        const size_t chunks = (frontier.size() + ANALYSIS_FRONTIER_CHUNK - 1) / ANALYSIS_FRONTIER_CHUNK;
+        const uint32_t level = distance + 2;
+        next.clear();
+
+        if (chunks > 1 && threadCount(threads) > 1) {
+            std::vector<std::vector<uint32_t>> parts(chunks);
+            parallelFor(static_cast<unsigned int>(chunks), threads, [&](const unsigned int chunk) {
+                const size_t first = chunk * ANALYSIS_FRONTIER_CHUNK, last = std::min(first + ANALYSIS_FRONTIER_CHUNK, frontier.size());
+                for (size_t i = first; i < last; i++) {
+                    forEachNeighbor(frontier[i], [&](const unsigned int cell) {
+                        uint32_t expected = 0;
+                        if (std::atomic_ref(distances[cell]).compare_exchange_strong(expected, level, std::memory_order_relaxed)) {
+                            parts[chunk].push_back(cell);
+                        }
+                    });
+                }
+            });
+            for (const std::vector<uint32_t> &part : parts) {
+                next.insert(next.end(), part.begin(), part.end());
+            }
+        } else {
+            for (const uint32_t cell : frontier) {
+                forEachNeighbor(cell, [&](const unsigned int neighbor) {
+                    if (distances[neighbor] == 0) {
+                        distances[neighbor] = level;
+                        next.push_back(neighbor);
+                    }
+                });
+            }
+        }
+
+        if (next.empty()) {
+            return *std::min_element(frontier.begin(), frontier.end());
+        }
+        reached += next.size();
+        distance++;
+        std::swap(frontier, next);
+    }
+}
+
+// The first search counts the component of the first cell, then every other cell left unvisited starts a new component.
+// From the farthest cell of the first search, a second search finds the diameter of a tree.
+void Analyzer::search(MazeAnalysis &analysis, const int threads) const {
+    const unsigned int size = _width * _height;
+    ZeroedArray<uint32_t> distances(size);
+
+    unsigned int distance;
+    uint64_t reached, total;
+    const unsigned int farthest = breadthFirst(0, distances, distance, reached, threads);
+    analysis.components = 1;
+    total = reached;
+
+    for (unsigned int cell = 1; cell < size && total != size; cell++) {
+        if (distances[cell] == 0) {
+            (void) breadthFirst(cell, distances, distance, reached, threads);
+            analysis.components++;
+            total += reached;
+        }
+    }
+
+    distances.reset(size);
+    analysis.diameterStart = farthest;
+    analysis.diameterEnd = breadthFirst(farthest, distances, analysis.diameter, reached, threads);
+}
+
+}
+
+MazeAnalysis analyzeMaze(const Maze &maze, const int threads) {
+    if (maze.size() > MAZE_MAX_INDEXED_CELLS) {
+        throw std::length_error("The analysis is limited to " + std::to_string(MAZE_MAX_INDEXED_CELLS) + " cells");
+    }
+
+    MazeAnalysis analysis;
+    analysis.width = maze.width();
+    analysis.height = maze.height();
+
+    const Analyzer analyzer(maze);
+    analyzer.scan(analysis, threads);
+    analyzer.search(analysis, threads);
+
+    analysis.loops = analysis.connections + analysis.components - static_cast<uint64_t>(analysis.width) * analysis.height;
+    return analysis;
+}
@@ -0,0 +1,66 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef MAZE_ANALYSIS_HPP
+#define MAZE_ANALYSIS_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "maze.hpp"
+
+struct MazeAnalysis {
+    unsigned int width = 0, height = 0;
+    uint64_t connections = 0, components = 0;
+
+    // Connections that could be removed without disconnecting any component: zero for a perfect maze.
+    uint64_t loops = 0;
+
+    // Cells by number of connections: isolated, dead ends, corridors, then junctions of 3 and 4 connections.
+    std::array<uint64_t, 5> degrees{};
+
+    // Number of corridors of each length, in connections between two cells that are not corridor cells.
+    std::vector<uint64_t> corridorLengths{};
+
+    // Longest shortest path in the component of the first cell and its ends.
+    // Exact when that component has no loop, a lower bound otherwise.
+    unsigned int diameter = 0;
+    unsigned int diameterStart = 0, diameterEnd = 0;
+
+    [[nodiscard]] uint64_t deadEnds() const;
+
+    [[nodiscard]] uint64_t junctions() const;
+
+    [[nodiscard]] bool isConnected() const;
+
+    [[nodiscard]] bool isPerfect() const;
+
+    // Connected with exactly the given number of loops, as generated with the matching error count.
+    [[nodiscard]] bool isValid(uint64_t errors) const;
+};
+
+// The wall grid is read once in bands of rows to classify cells with bit operations and walk corridors.
+// Components and the diameter then come from breadth-first searches that expand large frontiers in parallel.
+// Throws std::length_error when the maze has more than MAZE_MAX_INDEXED_CELLS cells.
+[[nodiscard]] MazeAnalysis analyzeMaze(const Maze &maze, int threads = 0);
+
+#endif //MAZE_ANALYSIS_HPP
@@ -0,0 +1,138 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "maze_cache.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QLockFile>
+#include <QSaveFile>
+#include <vector>
+
+#include "maze.hpp"
+
+constexpr qint64 MAZE_CACHE_COPY_BYTES = 1 << 20;
+
+QString hashKey(const QString &text, const QString &extension) {
+    return QString::fromLatin1(QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha256).toHex()) + extension;
+}
+
+QString mazeDescription(const WorkerParameters &parameters) {
+    return QString("maze;%1;%2;%3;%4;%5;%6;%7")
+        .arg(MAZE_ALGORITHM_VERSION)
+        .arg(parameters.seed)
+        .arg(parameters.width)
+        .arg(parameters.height)
+        .arg(parameters.errorFactor, 0, 'g', 17)
+        .arg(engineName(parameters.engine))
+        .arg(randomAlgorithmName(parameters.randomAlgorithm));
+}
+
+// The destination is replaced atomically, so a reader never sees a partial file.
+bool copyFile(const QString &source, const QString &destination) {
+    QFile input(source);
+    QSaveFile output(destination);
+    if (!input.open(QIODevice::ReadOnly) || !output.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    std::vector<char> buffer(MAZE_CACHE_COPY_BYTES);
+    qint64 size;
+    while ((size = input.read(buffer.data(), MAZE_CACHE_COPY_BYTES)) > 0) {
+        if (output.write(buffer.data(), size) != size) {
+            output.cancelWriting();
+            return false;
+        }
+    }
+
+    if (size < 0) {
+        output.cancelWriting();
+        return false;
+    }
+    return output.commit();
+}
+
+MazeCache::MazeCache(const QString &directory, const qint64 maxSize) : _directory(directory), _maxSize(maxSize) {
+    _directory.mkpath(".");
+}
+
+QString MazeCache::mazeKey(const WorkerParameters &parameters) {
+    return hashKey(mazeDescription(parameters), ".cmaze");
+}
+
+// The compression level is part of the key since it changes the bytes of the image.
+QString MazeCache::imageKey(const WorkerParameters &parameters) {
+    return hashKey(mazeDescription(parameters) + QString(";image;%1;%2;%3")
+        .arg(parameters.pathSize)
+        .arg(parameters.wallSize)
+        .arg(parameters.compressionLevel), ".png");
+}
+
+QString MazeCache::path(const QString &key) const {
+    return _directory.filePath(key);
+}
+
+// The modification time of a hit is refreshed for the eviction order, which needs the file to be writable on some platforms.
+// An entry that cannot be refreshed is reported as missing, so that it is written again as the most recent one.
+bool MazeCache::find(const QString &key) const {
+    QFile file(path(key));
+    if (!file.open(QIODevice::ReadWrite | QIODevice::ExistingOnly)) {
+        return false;
+    }
+    return file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+}
+
+bool MazeCache::fetch(const QString &key, const QString &fileName) const {
+    return find(key) && copyFile(path(key), fileName);
+}
+
+bool MazeCache::insert(const QString &key, const QString &fileName) const {
+    if (!copyFile(fileName, path(key))) {
+        return false;
+    }
+    evict();
+    return true;
+}
+
+// The lock only serializes evictions: entries are replaced atomically and may be written concurrently.
+void MazeCache::evict() const {
+    QLockFile lock(_directory.filePath("cache.lock"));
+    if (!lock.lock()) {
+        return;
+    }
+
+    const QFileInfoList entries = _directory.entryInfoList({"*.cmaze", "*.png"}, QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 size = 0;
+    for (const QFileInfo &entry : entries) {
+        size += entry.size();
+    }
+
+    for (const QFileInfo &entry : entries) {
+        if (size <= _maxSize) {
+            break;
+        }
+        if (QFile::remove(entry.absoluteFilePath())) {
+            size -= entry.size();
+        }
+    }
+}
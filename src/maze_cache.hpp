@@ -0,0 +1,62 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef MAZE_CACHE_HPP
+#define MAZE_CACHE_HPP
+
+#include <QDir>
+#include <QString>
+#include "worker.hpp"
+
+// Stores generated mazes and images in a directory, named after a hash of everything that determines their content.
+// Entries are written atomically, so several processes can share a cache. The least recently used entries are evicted
+// once the cache exceeds its maximum size.
+class MazeCache {
+    public:
+
+    MazeCache(const QString &directory, qint64 maxSize);
+
+    [[nodiscard]] static QString mazeKey(const WorkerParameters &parameters);
+
+    [[nodiscard]] static QString imageKey(const WorkerParameters &parameters);
+
+    [[nodiscard]] QString path(const QString &key) const;
+
+    // Returns whether the entry exists and could be marked as recently used.
+    bool find(const QString &key) const;
+
+    // Copies an entry to the given file.
+    bool fetch(const QString &key, const QString &fileName) const;
+
+    // Copies the given file into the cache.
+    bool insert(const QString &key, const QString &fileName) const;
+
+    void evict() const;
+
+    private:
+
+    QDir _directory;
+    const qint64 _maxSize;
+};
+
+
+#endif //MAZE_CACHE_HPP
@@ -0,0 +1,415 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "maze.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "parallel.hpp"
+
+constexpr unsigned int ENGINE_BAND_ROWS = 64;
+
+namespace {
+
+// Calls the function with std::true_type for a cell whose four neighbors exist and std::false_type for a border cell,
+// so that kernels instantiated for the interior have no border check left.
+template <typename Function>
+void withTopology(const bool interior, Function &&function) {
+    if (interior) {
+        function(std::true_type{});
+    } else {
+        function(std::false_type{});
+    }
+}
+
+// Bits of a word of a row for the columns below the limit.
+uint64_t columnMask(const unsigned int word, const unsigned int limit) {
+    const unsigned int first = word * 64;
+    if (limit <= first) {
+        return 0;
+    }
+    return limit - first >= 64 ? ~uint64_t{0} : (uint64_t{1} << (limit - first)) - 1;
+}
+
+}
+
+template <typename Generator>
+void Maze::connect(const Engine engine, Generator &generator, const double errorFactor, const int threads) {
+    switch (engine) {
+        case CLASSIC:
+            connectAll(generator, errorFactor);
+            return;
+        case TILED:
+            connectAllTiled(generator, errorFactor, threads);
+            return;
+        case STREAMING:
+            throw std::invalid_argument("The streaming engine does not generate mazes in memory");
+        default:
+            break;
+    }
+
+    if (errorFactor < 0 || errorFactor > 1) {
+        throw std::range_error("Error factor must be between 0 and 1");
+    }
+
+    if (!isParallelEngine(engine)) {
+        checkIndexedSize(std::string("The ") + engineName(engine) + " engine");
+    }
+
+    if (_progress->isCancelled()) {
+        return;
+    }
+
+    switch (engine) {
+        case WILSON:
+            connectWilson(generator);
+            break;
+        case PRIM:
+            connectPrim(generator);
+            break;
+        case BACKTRACKER:
+            connectBacktracker(generator);
+            break;
+        case SIDEWINDER:
+            connectSidewinder(generator, threads);
+            break;
+        default:
+            connectBinaryTree(generator, threads);
+            break;
+    }
+
+    if (_progress->isCancelled()) {
+        return;
+    }
+
+    if (const uint64_t errors = errorCount(errorFactor); errors != 0) {
+        connectSampledErrors(errors, generator);
+    }
+}
+
+bool Maze::isInterior(const unsigned int x, const unsigned int y) const {
+    return x != 0 && y != 0 && x + 1 < _width && y + 1 < _height;
+}
+
+template <typename Interior>
+bool Maze::hasNeighbor(const unsigned int x, const unsigned int y, const Direction direction) const {
+    if constexpr (Interior::value) {
+        return true;
+    } else {
+        const bool neighbors[] = {y != 0, y + 1 != _height, x != 0, x + 1 != _width};
+        return neighbors[direction];
+    }
+}
+
+unsigned int Maze::neighbor(const unsigned int position, const Direction direction) const {
+    const unsigned int offsets[] = {0u - _width, _width, 0u - 1, 1};
+    return position + offsets[direction];
+}
+
+// The wall between two cells is stored with the upper or left one.
+void Maze::openWall(const unsigned int position, const Direction direction) {
+    const unsigned int wall = direction == UP || direction == LEFT ? neighbor(position, direction) : position;
+    const unsigned int y = wall / _width, x = wall % _width;
+    if (direction == LEFT || direction == RIGHT) {
+        connectRight(x, y);
+    } else {
+        connectDown(x, y);
+    }
+}
+
+// Loop-erased random walks: from each cell outside the maze, walk randomly until the maze is reached, remembering only the
+// last direction taken from every cell in its direction byte, then carve the walk again following those directions.
+// The result is a uniform spanning tree, without the texture of the other engines.
+template <typename Generator>
+void Maze::connectWilson(Generator &generator) {
+    advise(RANDOM_ACCESS);
+
+    ZeroedArray<uint64_t> inside((_size + 63) / 64);
+    const auto isInside = [&](const unsigned int position) {
+        return inside[position >> 6] >> (position & 63) & 1;
+    };
+
+    const unsigned int root = randomBelow(generator, _size);
+    inside[root >> 6] |= uint64_t{1} << (root & 63);
+
+    _progress->start(CONNECTING, _size - 1);
+    unsigned int connections = 0;
+
+    for (unsigned int start = 0; start < _size && !_progress->isCancelled(); start++) {
+        if (isInside(start)) {
+            continue;
+        }
+
+        for (unsigned int position = start; !isInside(position);) {
+            const unsigned int y = position / _width, x = position % _width;
+            Direction direction = UP;
+            withTopology(isInterior(x, y), [&](auto interior) {
+                if constexpr (decltype(interior)::value) {
+                    direction = static_cast<Direction>(randomBelow(generator, 4));
+                } else {
+                    Direction directions[4];
+                    unsigned int count = 0;
+                    for (const Direction d : DIRECTIONS) {
+                        if (hasNeighbor<decltype(interior)>(x, y, d)) {
+                            directions[count++] = d;
+                        }
+                    }
+                    direction = directions[randomBelow(generator, count)];
+                }
+            });
+            _directions[position] = direction;
+            position = neighbor(position, direction);
+        }
+
+        for (unsigned int position = start; !isInside(position);) {
+            const auto direction = static_cast<Direction>(_directions[position]);
+            openWall(position, direction);
+            inside[position >> 6] |= uint64_t{1} << (position & 63);
+            position = neighbor(position, direction);
+            connections++;
+        }
+        _progress->update(connections);
+    }
+
+    if (_progress->isCancelled()) {
+        return;
+    }
+
+    _progress->finish();
+}
+
+// Grows the maze from a random cell, connecting a random frontier cell to a random neighbor already in the maze.
+// The direction byte of each cell tells whether it is outside, on the frontier or inside.
+template <typename Generator>
+void Maze::connectPrim(Generator &generator) {
+    constexpr uint8_t FRONTIER = 1, INSIDE = 2;
+
+    advise(RANDOM_ACCESS);
+
+    std::vector<uint32_t> frontier;
+    const auto add = [&](const unsigned int position) {
+        _directions[position] = INSIDE;
+        const unsigned int y = position / _width, x = position % _width;
+        withTopology(isInterior(x, y), [&](auto interior) {
+            for (const Direction direction : DIRECTIONS) {
+                if (hasNeighbor<decltype(interior)>(x, y, direction)) {
+                    if (const unsigned int next = neighbor(position, direction); _directions[next] == 0) {
+                        _directions[next] = FRONTIER;
+                        frontier.push_back(next);
+                    }
+                }
+            }
+        });
+    };
+
+    _progress->start(CONNECTING, _size - 1);
+    unsigned int connections = 0;
+    add(randomBelow(generator, _size));
+
+    while (!frontier.empty() && !_progress->isCancelled()) {
+        const uint32_t index = randomBelow(generator, static_cast<uint32_t>(frontier.size()));
+        const unsigned int position = frontier[index];
+        frontier[index] = frontier.back();
+        frontier.pop_back();
+
+        const unsigned int y = position / _width, x = position % _width;
+        Direction directions[4];
+        unsigned int count = 0;
+        withTopology(isInterior(x, y), [&](auto interior) {
+            for (const Direction direction : DIRECTIONS) {
+                if (hasNeighbor<decltype(interior)>(x, y, direction) && _directions[neighbor(position, direction)] == INSIDE) {
+                    directions[count++] = direction;
+                }
+            }
+        });
+
+        openWall(position, directions[count == 1 ? 0 : randomBelow(generator, count)]);
+        add(position);
+        _progress->update(++connections);
+    }
+
+    if (_progress->isCancelled()) {
+        return;
+    }
+
+    _progress->finish();
+}
+
+// Iterative depth-first search. Each cell keeps its shuffled directions and cursor in its direction byte,
+// as with the classic engine, so the stack only holds positions.
+template <typename Generator>
+void Maze::connectBacktracker(Generator &generator) {
+    advise(RANDOM_ACCESS);
+
+    ZeroedArray<uint64_t> visited((_size + 63) / 64);
+    std::vector<uint32_t> stack;
+    const auto push = [&](const unsigned int position) {
+        visited[position >> 6] |= uint64_t{1} << (position & 63);
+        _directions[position] = randomDirectionCombinationIndex(generator);
+        stack.push_back(position);
+    };
+
+    _progress->start(CONNECTING, _size - 1);
+    unsigned int connections = 0;
+    push(randomBelow(generator, _size));
+
+    while (!stack.empty() && !_progress->isCancelled()) {
+        const unsigned int position = stack.back();
+        uint8_t &state = _directions[position];
+        const int index = state >> DIRECTION_INDEX_SHIFT;
+        if (index == 4) {
+            stack.pop_back();
+            continue;
+        }
+
+        state += 1 << DIRECTION_INDEX_SHIFT;
+        const Direction direction = directionCombination(state & DIRECTION_COMBINATION_MASK)[index];
+        const unsigned int y = position / _width, x = position % _width;
+        withTopology(isInterior(x, y), [&](auto interior) {
+            if (!hasNeighbor<decltype(interior)>(x, y, direction)) {
+                return;
+            }
+            if (const unsigned int next = neighbor(position, direction); !(visited[next >> 6] >> (next & 63) & 1)) {
+                openWall(position, direction);
+                push(next);
+                _progress->update(++connections);
+            }
+        });
+    }
+
+    if (_progress->isCancelled()) {
+        return;
+    }
+
+    _progress->finish();
+}
+
+// Each row but the last is split in runs of random length, each joined to the row below by one of its cells.
+// The last row is a single corridor. Rows are independent, with a generator per row derived like the tiles of the tiled engine,
+// so they are connected in parallel bands a word of 64 cells at a time.
+template <typename Generator>
+void Maze::connectSidewinder(Generator &generator, const int threads) {
+    const typename Generator::result_type seed = generator();
+    const unsigned int bands = (_height + ENGINE_BAND_ROWS - 1) / ENGINE_BAND_ROWS;
+
+    advise(SEQUENTIAL_ACCESS);
+    _progress->start(CONNECTING, _height);
+
+    parallelFor(bands, threads, [&](const unsigned int band) {
+        if (_progress->isCancelled()) {
+            return;
+        }
+
+        const unsigned int last = std::min((band + 1) * ENGINE_BAND_ROWS, _height);
+        for (unsigned int y = band * ENGINE_BAND_ROWS; y < last; y++) {
+            uint64_t *right = _right.data() + static_cast<size_t>(y) * _stride, *down = _down.data() + static_cast<size_t>(y) * _stride;
+            if (y == _height - 1) {
+                for (unsigned int i = 0; i < _stride; i++) {
+                    right[i] = columnMask(i, _width - 1);
+                }
+                continue;
+            }
+
+            Generator rowGenerator = makeTileGenerator<Generator>(seed, y);
+            unsigned int runStart = 0;
+            for (unsigned int i = 0; i < _stride; i++) {
+                const uint64_t cells = columnMask(i, _width);
+                uint64_t ends = randomWord(rowGenerator) & cells;
+                if (i == _stride - 1) {
+                    ends |= uint64_t{1} << ((_width - 1) & 63);
+                }
+                right[i] = ~ends & cells;
+
+                for (; ends != 0; ends &= ends - 1) {
+                    const unsigned int x = i * 64 + std::countr_zero(ends);
+                    const unsigned int cell = runStart + randomBelow(rowGenerator, x - runStart + 1);
+                    down[cell >> 6] |= uint64_t{1} << (cell & 63);
+                    runStart = x + 1;
+                }
+            }
+        }
+
+        _progress->add(last - band * ENGINE_BAND_ROWS);
+    });
+
+    if (_progress->isCancelled()) {
+        return;
+    }
+
+    _progress->finish();
+}
+
+// Every cell is connected either right or down, which only needs random bits: one word of walls per word of randomness.
+// The last column can only go down and the last row only right. Rows are independent, as with the sidewinder engine.
+template <typename Generator>
+void Maze::connectBinaryTree(Generator &generator, const int threads) {
+    const typename Generator::result_type seed = generator();
+    const unsigned int bands = (_height + ENGINE_BAND_ROWS - 1) / ENGINE_BAND_ROWS;
+
+    advise(SEQUENTIAL_ACCESS);
+    _progress->start(CONNECTING, _height);
+
+    parallelFor(bands, threads, [&](const unsigned int band) {
+        if (_progress->isCancelled()) {
+            return;
+        }
+
+        const unsigned int last = std::min((band + 1) * ENGINE_BAND_ROWS, _height);
+        for (unsigned int y = band * ENGINE_BAND_ROWS; y < last; y++) {
+            uint64_t *right = _right.data() + static_cast<size_t>(y) * _stride, *down = _down.data() + static_cast<size_t>(y) * _stride;
+            if (y == _height - 1) {
+                for (unsigned int i = 0; i < _stride; i++) {
+                    right[i] = columnMask(i, _width - 1);
+                }
+                continue;
+            }
+
+            Generator rowGenerator = makeTileGenerator<Generator>(seed, y);
+            for (unsigned int i = 0; i < _stride; i++) {
+                const uint64_t rights = randomWord(rowGenerator) & columnMask(i, _width - 1);
+                right[i] = rights;
+                down[i] = ~rights & columnMask(i, _width);
+            }
+        }
+
+        _progress->add(last - band * ENGINE_BAND_ROWS);
+    });
+
+    if (_progress->isCancelled()) {
+        return;
+    }
+
+    _progress->finish();
+}
+
+template void Maze::connect(Engine engine, std::mt19937 &generator, double errorFactor, int threads);
+template void Maze::connect(Engine engine, Xoshiro256 &generator, double errorFactor, int threads);
+template void Maze::connect(Engine engine, Pcg64 &generator, double errorFactor, int threads);
+template void Maze::connect(Engine engine, SplitMix64 &generator, double errorFactor, int threads);
+template void Maze::connect(Engine engine, LoopSampling<Xoshiro256> &generator, double errorFactor, int threads);
+template void Maze::connect(Engine engine, LoopSampling<Pcg64> &generator, double errorFactor, int threads);
+template void Maze::connect(Engine engine, LoopSampling<SplitMix64> &generator, double errorFactor, int threads);
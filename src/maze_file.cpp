@@ -0,0 +1,272 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "maze_file.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <zlib.h>
+
+#include "parallel.hpp"
+
+static_assert(std::endian::native == std::endian::little, "Maze files store little-endian words");
+
+constexpr char MAZE_FILE_MAGIC[4] = {'C', 'M', 'A', 'Z'};
+constexpr size_t MAZE_FILE_HEADER_SIZE = 40;
+constexpr size_t MAZE_FILE_TILE_ENTRY_SIZE = 16;
+
+template <typename T>
+void put(uchar *data, const size_t offset, const T value) {
+    std::memcpy(data + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T get(const uchar *data, const size_t offset) {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+unsigned int tileCount(const unsigned int size) {
+    return (size + MAZE_FILE_TILE_SIZE - 1) / MAZE_FILE_TILE_SIZE;
+}
+
+unsigned int tileWords(const unsigned int size, const unsigned int tile) {
+    return (std::min(MAZE_FILE_TILE_SIZE, size - tile * MAZE_FILE_TILE_SIZE) + 63) / 64;
+}
+
+void copyBits(const uint64_t *source, size_t sourceBit, uint64_t *destination, size_t destinationBit, size_t count) {
+    while (count != 0) {
+        const size_t length = std::min({count, 64 - (sourceBit & 63), 64 - (destinationBit & 63)});
+        const uint64_t mask = length == 64 ? ~uint64_t{0} : (uint64_t{1} << length) - 1;
+        destination[destinationBit >> 6] |= (source[sourceBit >> 6] >> (sourceBit & 63) & mask) << (destinationBit & 63);
+        sourceBit += length;
+        destinationBit += length;
+        count -= length;
+    }
+}
+
+MazeFileWriter::MazeFileWriter(const QString &fileName, const int compressionLevel, const int threads) :
+    _file(fileName), _compressionLevel(compressionLevel), _threads(threads) {}
+
+bool MazeFileWriter::open(const MazeFileInfo &info) {
+    _info = info;
+    _stride = (info.width + 63) / 64;
+    _tilesX = tileCount(info.width);
+    _right.assign(static_cast<size_t>(_stride) * MAZE_FILE_TILE_SIZE, 0);
+    _down.assign(static_cast<size_t>(_stride) * MAZE_FILE_TILE_SIZE, 0);
+    _rows = 0;
+    _tileCount = static_cast<size_t>(_tilesX) * tileCount(info.height);
+    _tiles.clear();
+    _tiles.reserve(_tileCount);
+
+    if (!_file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    uchar header[MAZE_FILE_HEADER_SIZE] = {};
+    std::memcpy(header, MAZE_FILE_MAGIC, sizeof(MAZE_FILE_MAGIC));
+    put<uint16_t>(header, 4, MAZE_FILE_VERSION);
+    put<uint16_t>(header, 6, MAZE_FILE_TILE_SIZE);
+    put<uint32_t>(header, 8, info.width);
+    put<uint32_t>(header, 12, info.height);
+    put<int32_t>(header, 16, info.seed);
+    put<uint32_t>(header, 20, info.algorithmVersion);
+    put<double>(header, 24, info.errorFactor);
+    put<uint8_t>(header, 32, info.engine);
+    put<uint8_t>(header, 33, info.randomAlgorithm);
+
+    // The index is only known once every tile is written, its space is reserved now and filled by finish.
+    const std::vector<char> index(_tileCount * MAZE_FILE_TILE_ENTRY_SIZE, 0);
+    _failed = _file.write(reinterpret_cast<const char *>(header), MAZE_FILE_HEADER_SIZE) != MAZE_FILE_HEADER_SIZE
+        || _file.write(index.data(), static_cast<qint64>(index.size())) != static_cast<qint64>(index.size());
+    _offset = MAZE_FILE_HEADER_SIZE + index.size();
+    return !_failed;
+}
+
+void MazeFileWriter::addRow(const uint64_t *right, const uint64_t *down) {
+    std::copy_n(right, _stride, _right.data() + static_cast<size_t>(_rows) * _stride);
+    std::copy_n(down, _stride, _down.data() + static_cast<size_t>(_rows) * _stride);
+    _rows++;
+
+    if (_rows == MAZE_FILE_TILE_SIZE || _tiles.size() / _tilesX * MAZE_FILE_TILE_SIZE + _rows == _info.height) {
+        writeBand();
+    }
+}
+
+// The tiles of a band are compressed concurrently and then written in order.
+void MazeFileWriter::writeBand() {
+    std::vector<std::vector<Bytef>> tiles(_tilesX);
+    std::atomic<bool> compressed = true;
+
+    parallelFor(_tilesX, _threads, [&](const unsigned int tileX) {
+        const unsigned int words = tileWords(_info.width, tileX);
+        std::vector<uint64_t> raw;
+        raw.reserve(static_cast<size_t>(_rows) * 2 * words);
+        for (unsigned int row = 0; row < _rows; row++) {
+            const size_t offset = static_cast<size_t>(row) * _stride + static_cast<size_t>(tileX) * (MAZE_FILE_TILE_SIZE / 64);
+            raw.insert(raw.end(), _right.data() + offset, _right.data() + offset + words);
+            raw.insert(raw.end(), _down.data() + offset, _down.data() + offset + words);
+        }
+
+        const uLong rawSize = raw.size() * sizeof(uint64_t);
+        uLongf size = compressBound(rawSize);
+        std::vector<Bytef> &tile = tiles[tileX];
+        tile.resize(size);
+        if (compress2(tile.data(), &size, reinterpret_cast<const Bytef *>(raw.data()), rawSize, _compressionLevel) != Z_OK) {
+            compressed.store(false, std::memory_order_relaxed);
+        }
+        tile.resize(size);
+    });
+
+    _failed = _failed || !compressed.load(std::memory_order_relaxed);
+
+    for (const std::vector<Bytef> &tile : tiles) {
+        _tiles.push_back({_offset, tile.size()});
+        _offset += tile.size();
+        if (!_failed && _file.write(reinterpret_cast<const char *>(tile.data()), static_cast<qint64>(tile.size())) != static_cast<qint64>(tile.size())) {
+            _failed = true;
+        }
+    }
+
+    _rows = 0;
+}
+
+bool MazeFileWriter::finish() {
+    if (_failed || _tiles.size() != _tileCount) {
+        cancel();
+        return false;
+    }
+
+    std::vector<uchar> index(_tiles.size() * MAZE_FILE_TILE_ENTRY_SIZE, 0);
+    for (size_t i = 0; i < _tiles.size(); i++) {
+        put<uint64_t>(index.data(), i * MAZE_FILE_TILE_ENTRY_SIZE, _tiles[i].offset);
+        put<uint64_t>(index.data(), i * MAZE_FILE_TILE_ENTRY_SIZE + 8, _tiles[i].size);
+    }
+
+    if (!_file.seek(MAZE_FILE_HEADER_SIZE) || _file.write(reinterpret_cast<const char *>(index.data()), static_cast<qint64>(index.size())) != static_cast<qint64>(index.size())) {
+        cancel();
+        return false;
+    }
+    return _file.commit();
+}
+
+void MazeFileWriter::cancel() {
+    _file.cancelWriting();
+}
+
+MazeFile::MazeFile(const QString &fileName) : _file(fileName) {}
+
+bool MazeFile::open() {
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    _size = _file.size();
+    if (_size < MAZE_FILE_HEADER_SIZE || (_data = _file.map(0, static_cast<qint64>(_size))) == nullptr) {
+        return false;
+    }
+
+    if (std::memcmp(_data, MAZE_FILE_MAGIC, sizeof(MAZE_FILE_MAGIC)) != 0
+        || get<uint16_t>(_data, 4) != MAZE_FILE_VERSION || get<uint16_t>(_data, 6) != MAZE_FILE_TILE_SIZE) {
+        return false;
+    }
+
+    _info.width = get<uint32_t>(_data, 8);
+    _info.height = get<uint32_t>(_data, 12);
+    _info.seed = get<int32_t>(_data, 16);
+    _info.algorithmVersion = get<uint32_t>(_data, 20);
+    _info.errorFactor = get<double>(_data, 24);
+    _info.engine = get<uint8_t>(_data, 32);
+    _info.randomAlgorithm = static_cast<RandomAlgorithm>(get<uint8_t>(_data, 33));
+
+    if (_info.width == 0 || _info.height == 0) {
+        return false;
+    }
+
+    _tilesX = tileCount(_info.width);
+    _tilesY = tileCount(_info.height);
+    const uint64_t tiles = static_cast<uint64_t>(_tilesX) * _tilesY;
+    if ((_size - MAZE_FILE_HEADER_SIZE) / MAZE_FILE_TILE_ENTRY_SIZE < tiles) {
+        return false;
+    }
+
+    _tiles.resize(tiles);
+    for (size_t i = 0; i < tiles; i++) {
+        MazeFileTile &tile = _tiles[i];
+        tile.offset = get<uint64_t>(_data, MAZE_FILE_HEADER_SIZE + i * MAZE_FILE_TILE_ENTRY_SIZE);
+        tile.size = get<uint64_t>(_data, MAZE_FILE_HEADER_SIZE + i * MAZE_FILE_TILE_ENTRY_SIZE + 8);
+        if (tile.offset > _size || tile.size > _size - tile.offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const MazeFileInfo& MazeFile::info() const {
+    return _info;
+}
+
+bool MazeFile::readTile(const unsigned int tile, std::vector<uint64_t> &words) const {
+    const unsigned int tileX = tile % _tilesX, tileY = tile / _tilesX;
+    const unsigned int rows = std::min(MAZE_FILE_TILE_SIZE, _info.height - tileY * MAZE_FILE_TILE_SIZE);
+    words.resize(static_cast<size_t>(rows) * 2 * tileWords(_info.width, tileX));
+
+    const uLong rawSize = words.size() * sizeof(uint64_t);
+    uLongf size = rawSize;
+    const MazeFileTile &entry = _tiles[tile];
+    return uncompress(reinterpret_cast<Bytef *>(words.data()), &size, _data + entry.offset, entry.size) == Z_OK && size == rawSize;
+}
+
+bool MazeFile::readRegion(const Region &region, uint64_t *right, uint64_t *down, const size_t stride) const {
+    if (_data == nullptr || region.left >= region.right || region.top >= region.bottom || region.right > _info.width || region.bottom > _info.height) {
+        return false;
+    }
+
+    std::vector<uint64_t> words;
+    for (unsigned int tileY = region.top / MAZE_FILE_TILE_SIZE; tileY <= (region.bottom - 1) / MAZE_FILE_TILE_SIZE; tileY++) {
+        for (unsigned int tileX = region.left / MAZE_FILE_TILE_SIZE; tileX <= (region.right - 1) / MAZE_FILE_TILE_SIZE; tileX++) {
+            if (!readTile(tileY * _tilesX + tileX, words)) {
+                return false;
+            }
+
+            const unsigned int tileLeft = tileX * MAZE_FILE_TILE_SIZE, tileTop = tileY * MAZE_FILE_TILE_SIZE;
+            const unsigned int minX = std::max(region.left, tileLeft), maxX = std::min(region.right, tileLeft + MAZE_FILE_TILE_SIZE);
+            const unsigned int minY = std::max(region.top, tileTop), maxY = std::min(region.bottom, tileTop + MAZE_FILE_TILE_SIZE);
+            const unsigned int rowWords = tileWords(_info.width, tileX);
+            // A corrupt file could connect the last column to the right or the last row down: those walls are left closed.
+            const unsigned int rightCells = maxX - minX - (maxX == _info.width ? 1 : 0);
+
+            for (unsigned int y = minY; y < maxY; y++) {
+                const uint64_t *row = words.data() + static_cast<size_t>(y - tileTop) * 2 * rowWords;
+                const size_t offset = static_cast<size_t>(y - region.top) * stride;
+                copyBits(row, minX - tileLeft, right + offset, minX - region.left, rightCells);
+                if (y != _info.height - 1) {
+                    copyBits(row + rowWords, minX - tileLeft, down + offset, minX - region.left, maxX - minX);
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,110 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef MAZE_FILE_HPP
+#define MAZE_FILE_HPP
+
+#include <QFile>
+#include <QSaveFile>
+#include <cstdint>
+#include <vector>
+#include "maze.hpp"
+
+constexpr uint16_t MAZE_FILE_VERSION = 1;
+constexpr unsigned int MAZE_FILE_TILE_SIZE = 256;
+
+struct MazeFileInfo {
+    unsigned int width, height;
+    int seed;
+    double errorFactor;
+    int engine;
+    RandomAlgorithm randomAlgorithm;
+    unsigned int algorithmVersion = MAZE_ALGORITHM_VERSION;
+};
+
+struct MazeFileTile {
+    uint64_t offset, size;
+};
+
+// Copies count bits from an arbitrary bit position to another, the destination bits must be zeroed.
+void copyBits(const uint64_t *source, size_t sourceBit, uint64_t *destination, size_t destinationBit, size_t count);
+
+// A maze file starts with a fixed header followed by the index of its tiles.
+// Each tile stores, for each of its rows, the right walls then the down walls packed as 64-bit words.
+// Tiles are compressed independently so that any region can be read without decoding the rest of the maze.
+class MazeFileWriter {
+    public:
+
+    MazeFileWriter(const QString &fileName, int compressionLevel, int threads);
+
+    bool open(const MazeFileInfo &info);
+
+    // Rows are added in order, each one as right and down words in the layout of a maze row.
+    void addRow(const uint64_t *right, const uint64_t *down);
+
+    bool finish();
+
+    void cancel();
+
+    private:
+
+    void writeBand();
+
+    QSaveFile _file;
+    const int _compressionLevel, _threads;
+    MazeFileInfo _info{};
+    unsigned int _stride = 0, _tilesX = 0;
+    std::vector<uint64_t> _right, _down;
+    unsigned int _rows = 0;
+    size_t _tileCount = 0;
+    std::vector<MazeFileTile> _tiles;
+    uint64_t _offset = 0;
+    bool _failed = false;
+};
+
+class MazeFile {
+    public:
+
+    explicit MazeFile(const QString &fileName);
+
+    bool open();
+
+    [[nodiscard]] const MazeFileInfo& info() const;
+
+    // Walls of the region are written to rows of the given stride in words, starting at the first bit of each row.
+    // The destination must be zeroed. Only the tiles overlapping the region are decoded.
+    bool readRegion(const Region &region, uint64_t *right, uint64_t *down, size_t stride) const;
+
+    private:
+
+    bool readTile(unsigned int tile, std::vector<uint64_t> &words) const;
+
+    QFile _file;
+    const uchar *_data = nullptr;
+    uint64_t _size = 0;
+    MazeFileInfo _info{};
+    unsigned int _tilesX = 0, _tilesY = 0;
+    std::vector<MazeFileTile> _tiles;
+};
+
+
+#endif //MAZE_FILE_HPP
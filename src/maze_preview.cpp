@@ -0,0 +1,157 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "maze_preview.hpp"
+
+#include <QCoreApplication>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPointer>
+#include <QThreadPool>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+quint64 tileKey(const unsigned int level, const uint64_t x, const uint64_t y) {
+    return static_cast<quint64>(level) << 58 | y << 29 | x;
+}
+
+MazePreview::MazePreview(std::shared_ptr<const Maze> maze, const int pathSize, const int wallSize, QWidget *parent) :
+    QWidget(parent), _maze(std::move(maze)), _deepZoom(std::make_shared<DeepZoom>(*_maze, pathSize, wallSize)) {
+    setWindowTitle(QString("Preview (%1x%2)").arg(_maze->width()).arg(_maze->height()));
+    setCursor(Qt::OpenHandCursor);
+    resize(800, 600);
+
+    // The whole maze fits in the window at first.
+    const unsigned int maxLevel = _deepZoom->levelCount() - 1;
+    const double fit = std::min(width() / static_cast<double>(_deepZoom->width(maxLevel)), height() / static_cast<double>(_deepZoom->height(maxLevel)));
+    _zoom = std::clamp(static_cast<int>(std::floor(std::log2(fit))), -static_cast<int>(maxLevel), MAZE_PREVIEW_MAX_ZOOM);
+}
+
+double MazePreview::scale() const {
+    return std::ldexp(1.0, _zoom);
+}
+
+// Tiles of the current level are drawn when they are cached, the others are requested and drawn once rendered.
+void MazePreview::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+
+    const unsigned int level = _deepZoom->levelCount() - 1 + std::min(_zoom, 0);
+    const double levelScale = std::ldexp(1.0, std::max(_zoom, 0));
+    const QPointF origin = _origin * std::ldexp(1.0, std::min(_zoom, 0));
+    const uint64_t levelWidth = _deepZoom->width(level), levelHeight = _deepZoom->height(level);
+
+    const double right = (origin.x() + width() / levelScale) / DEEP_ZOOM_TILE_SIZE, bottom = (origin.y() + height() / levelScale) / DEEP_ZOOM_TILE_SIZE;
+    if (right < 0 || bottom < 0) {
+        return;
+    }
+
+    const auto firstX = static_cast<uint64_t>(std::max(0.0, std::floor(origin.x() / DEEP_ZOOM_TILE_SIZE)));
+    const auto firstY = static_cast<uint64_t>(std::max(0.0, std::floor(origin.y() / DEEP_ZOOM_TILE_SIZE)));
+    const uint64_t lastX = std::min((levelWidth - 1) / DEEP_ZOOM_TILE_SIZE, static_cast<uint64_t>(right));
+    const uint64_t lastY = std::min((levelHeight - 1) / DEEP_ZOOM_TILE_SIZE, static_cast<uint64_t>(bottom));
+
+    for (uint64_t y = firstY; y <= lastY; y++) {
+        for (uint64_t x = firstX; x <= lastX; x++) {
+            const quint64 key = tileKey(level, x, y);
+            if (const QImage *image = _tiles.object(key); image != nullptr) {
+                const QRectF target(
+                    (static_cast<double>(x * DEEP_ZOOM_TILE_SIZE) - origin.x()) * levelScale, (static_cast<double>(y * DEEP_ZOOM_TILE_SIZE) - origin.y()) * levelScale,
+                    image->width() * levelScale, image->height() * levelScale
+                );
+                painter.drawImage(target, *image);
+            } else {
+                requestTile(level, x, y, key);
+            }
+        }
+    }
+}
+
+void MazePreview::mousePressEvent(QMouseEvent *event) {
+    _lastMouse = event->position();
+}
+
+void MazePreview::mouseMoveEvent(QMouseEvent *event) {
+    if (event->buttons() & Qt::LeftButton) {
+        _origin -= (event->position() - _lastMouse) / scale();
+        _lastMouse = event->position();
+        update();
+    }
+}
+
+void MazePreview::wheelEvent(QWheelEvent *event) {
+    if (const int steps = event->angleDelta().y() / 120; steps != 0) {
+        setZoom(_zoom + steps, event->position());
+    }
+}
+
+// The point of the maze under the anchor stays under it.
+void MazePreview::setZoom(int zoom, const QPointF &anchor) {
+    zoom = std::clamp(zoom, 1 - static_cast<int>(_deepZoom->levelCount()), MAZE_PREVIEW_MAX_ZOOM);
+    if (zoom == _zoom) {
+        return;
+    }
+
+    const QPointF point = _origin + anchor / scale();
+    _zoom = zoom;
+    _origin = point - anchor / scale();
+
+    // Tiles requested for the previous zoom level are no longer rendered.
+    _version->fetch_add(1, std::memory_order_relaxed);
+    update();
+}
+
+void MazePreview::requestTile(const unsigned int level, const uint64_t x, const uint64_t y, const quint64 key) {
+    if (_pending.contains(key)) {
+        return;
+    }
+    _pending.insert(key);
+
+    const unsigned int version = _version->load(std::memory_order_relaxed);
+    QThreadPool::globalInstance()->start([maze = _maze, deepZoom = _deepZoom, currentVersion = _version, preview = QPointer(this), level, x, y, key, version] {
+        QImage image;
+        if (currentVersion->load(std::memory_order_relaxed) == version) {
+            const uint64_t left = x * DEEP_ZOOM_TILE_SIZE, top = y * DEEP_ZOOM_TILE_SIZE;
+            image = QImage(
+                static_cast<int>(std::min<uint64_t>(DEEP_ZOOM_TILE_SIZE, deepZoom->width(level) - left)),
+                static_cast<int>(std::min<uint64_t>(DEEP_ZOOM_TILE_SIZE, deepZoom->height(level) - top)),
+                QImage::Format_Grayscale8
+            );
+            deepZoom->render(level, left, top, image.width(), image.height(), image.bits(), image.bytesPerLine());
+        }
+
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [preview, key, image] {
+            if (preview != nullptr) {
+                preview->tileRendered(key, image);
+            }
+        });
+    });
+}
+
+void MazePreview::tileRendered(const quint64 key, const QImage &image) {
+    _pending.remove(key);
+    if (!image.isNull()) {
+        _tiles.insert(key, new QImage(image));
+    }
+    update();
+}
@@ -0,0 +1,81 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef MAZE_PREVIEW_HPP
+#define MAZE_PREVIEW_HPP
+
+#include <QCache>
+#include <QImage>
+#include <QPointF>
+#include <QSet>
+#include <QWidget>
+#include <atomic>
+#include <memory>
+#include "deep_zoom.hpp"
+
+constexpr int MAZE_PREVIEW_CACHE_TILES = 1024;
+constexpr int MAZE_PREVIEW_MAX_ZOOM = 5;
+
+// Shows a maze kept in memory: only the visible tiles are rendered, in the background, at the current zoom level.
+// Zooming out uses the levels of the deep zoom pyramid, zooming in magnifies the full image.
+class MazePreview : public QWidget {
+    Q_OBJECT
+    public:
+
+    MazePreview(std::shared_ptr<const Maze> maze, int pathSize, int wallSize, QWidget *parent = nullptr);
+
+    protected:
+
+    void paintEvent(QPaintEvent *event) override;
+
+    void mousePressEvent(QMouseEvent *event) override;
+
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+    void wheelEvent(QWheelEvent *event) override;
+
+    private:
+
+    // Screen pixels per pixel of the full image.
+    [[nodiscard]] double scale() const;
+
+    void setZoom(int zoom, const QPointF &anchor);
+
+    void requestTile(unsigned int level, uint64_t x, uint64_t y, quint64 key);
+
+    void tileRendered(quint64 key, const QImage &image);
+
+    std::shared_ptr<const Maze> _maze;
+    std::shared_ptr<const DeepZoom> _deepZoom;
+
+    // Zoom is a power of two: negative values use a smaller level, positive ones magnify the full image.
+    int _zoom = 0;
+    QPointF _origin{0, 0};
+    QPointF _lastMouse{0, 0};
+
+    QCache<quint64, QImage> _tiles{MAZE_PREVIEW_CACHE_TILES};
+    QSet<quint64> _pending;
+    std::shared_ptr<std::atomic<unsigned int>> _version = std::make_shared<std::atomic<unsigned int>>(0);
+};
+
+
+#endif //MAZE_PREVIEW_HPP
@@ -0,0 +1,118 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include <QThread>
+#include <QThreadPool>
+
+namespace {
+
+// One pool serves every parallel loop, so its threads are started once instead of on each call.
+// It only grows, up to the largest number of helpers requested so far.
+QThreadPool& helperPool(const int helpers) {
+    static QThreadPool pool;
+    static std::mutex mutex;
+
+    const std::lock_guard lock(mutex);
+    if (pool.maxThreadCount() < helpers) {
+        pool.setMaxThreadCount(helpers);
+    }
+    return pool;
+}
+
+// The state of one loop, shared with its helpers which may start after the loop is over.
+// A task that throws stops the loop, and its exception is rethrown to the caller once the claimed tasks are done.
+class ParallelLoop {
+    public:
+
+    ParallelLoop(const unsigned int count, const std::function<void(unsigned int)> &task) : _count(count), _task(&task) {}
+
+    void run() {
+        for (unsigned int i; (i = _next.fetch_add(1, std::memory_order_relaxed)) < _count;) {
+            if (!_failed.load(std::memory_order_relaxed)) {
+                try {
+                    (*_task)(i);
+                } catch (...) {
+                    if (!_failed.exchange(true)) {
+                        _error = std::current_exception();
+                    }
+                }
+            }
+            if (_done.fetch_add(1, std::memory_order_acq_rel) + 1 == _count) {
+                _done.notify_all();
+            }
+        }
+    }
+
+    void wait() {
+        for (unsigned int done; (done = _done.load(std::memory_order_acquire)) < _count;) {
+            _done.wait(done, std::memory_order_acquire);
+        }
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+    private:
+
+    const unsigned int _count;
+    const std::function<void(unsigned int)> *_task;
+    std::atomic<unsigned int> _next{0}, _done{0};
+    std::atomic<bool> _failed{false};
+    std::exception_ptr _error;
+};
+
+}
+
+int threadCount(const int threads) {
+    return threads > 0 ? threads : std::max(QThread::idealThreadCount(), 1);
+}
+
+void parallelFor(const unsigned int count, const int threads, const std::function<void(unsigned int)> &task) {
+    const unsigned int workers = std::min(static_cast<unsigned int>(threadCount(threads)), count);
+    if (workers <= 1) {
+        for (unsigned int i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    // Tasks are claimed one at a time from a shared counter so idle threads keep picking up remaining work.
+    // The caller claims tasks too, so the loop completes even when every thread of the pool is busy, for example
+    // with the loops of other callers. Helpers that start late find no task left and only release the shared state.
+    const auto loop = std::make_shared<ParallelLoop>(count, task);
+    QThreadPool &pool = helperPool(static_cast<int>(workers - 1));
+    for (unsigned int i = 1; i < workers; i++) {
+        pool.start([loop] {
+            loop->run();
+        });
+    }
+    loop->run();
+    loop->wait();
+}
@@ -0,0 +1,204 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "path_index.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#include "parallel.hpp"
+
+constexpr unsigned int PATH_INDEX_QUERY_BATCH = 4096;
+
+// A spanning tree has exactly one connection less than cells. The count is checked first, then the traversal checks that
+// every cell is reached, which together rule out loops.
+PathIndex::PathIndex(const Maze &maze, const int threads) : _maze(maze), _width(maze.width()), _size(static_cast<unsigned int>(maze.size())) {
+    if (maze.size() > MAZE_MAX_INDEXED_CELLS) {
+        throw std::length_error("The path index is limited to " + std::to_string(MAZE_MAX_INDEXED_CELLS) + " cells");
+    }
+
+    const unsigned int height = maze.height(), words = (_width + 63) / 64;
+    std::atomic<uint64_t> connections{0};
+    parallelFor(height, threads, [&](const unsigned int y) {
+        const uint64_t *right = maze.rightRow(y), *down = maze.downRow(y);
+        uint64_t count = 0;
+        for (unsigned int i = 0; i < words; i++) {
+            count += std::popcount(right[i]) + std::popcount(down[i]);
+        }
+        connections.fetch_add(count, std::memory_order_relaxed);
+    });
+
+    if (connections.load() != _size - 1) {
+        throw std::invalid_argument("The maze is not perfect: " + std::to_string(connections.load()) + " connections for " + std::to_string(_size) + " cells");
+    }
+
+    buildOrder();
+    buildTable(threads);
+}
+
+// Iterative depth-first traversal: the preorder index is stored plus one, so that zero marks an unvisited cell.
+void PathIndex::buildOrder() {
+    _order.reset(_size);
+    _depths.reset(_size);
+
+    const unsigned int height = _size / _width;
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    stack.emplace_back(0, 0);
+    unsigned int index = 0;
+
+    while (!stack.empty()) {
+        const auto [cell, depth] = stack.back();
+        stack.pop_back();
+        if (_order[cell] != 0) {
+            continue;
+        }
+
+        _order[cell] = ++index;
+        _depths[index - 1] = depth;
+
+        const unsigned int x = cell % _width, y = cell / _width;
+        if (x != 0 && _maze.isConnectedRight(x - 1, y) && _order[cell - 1] == 0) {
+            stack.emplace_back(cell - 1, depth + 1);
+        }
+        if (x != _width - 1 && _maze.isConnectedRight(x, y) && _order[cell + 1] == 0) {
+            stack.emplace_back(cell + 1, depth + 1);
+        }
+        if (y != 0 && _maze.isConnectedDown(x, y - 1) && _order[cell - _width] == 0) {
+            stack.emplace_back(cell - _width, depth + 1);
+        }
+        if (y != height - 1 && _maze.isConnectedDown(x, y) && _order[cell + _width] == 0) {
+            stack.emplace_back(cell + _width, depth + 1);
+        }
+    }
+
+    if (index != _size) {
+        throw std::invalid_argument("The maze is not perfect: " + std::to_string(_size - index) + " unreachable cells");
+    }
+}
+
+void PathIndex::buildTable(const int threads) {
+    _blocks = (_size + PATH_INDEX_BLOCK_SIZE - 1) / PATH_INDEX_BLOCK_SIZE;
+    const unsigned int levels = std::bit_width(_blocks);
+    _table.resize(static_cast<size_t>(_blocks) * levels);
+
+    parallelFor(_blocks, threads, [&](const unsigned int block) {
+        const unsigned int first = block * PATH_INDEX_BLOCK_SIZE, last = std::min(first + PATH_INDEX_BLOCK_SIZE, _size);
+        _table[block] = *std::min_element(_depths.data() + first, _depths.data() + last);
+    });
+
+    for (unsigned int level = 1; level < levels; level++) {
+        const uint32_t *previous = _table.data() + static_cast<size_t>(level - 1) * _blocks;
+        uint32_t *current = _table.data() + static_cast<size_t>(level) * _blocks;
+        const unsigned int half = 1u << (level - 1), count = _blocks - (1u << level) + 1;
+        parallelFor(count, threads, [&](const unsigned int block) {
+            current[block] = std::min(previous[block], previous[block + half]);
+        });
+    }
+}
+
+unsigned int PathIndex::depth(const unsigned int cell) const {
+    return _depths[_order[cell] - 1];
+}
+
+// Minimum depth between two preorder indices, both included.
+unsigned int PathIndex::minimumDepth(const unsigned int first, const unsigned int last) const {
+    const unsigned int firstBlock = first / PATH_INDEX_BLOCK_SIZE, lastBlock = last / PATH_INDEX_BLOCK_SIZE;
+    if (firstBlock == lastBlock) {
+        return *std::min_element(_depths.data() + first, _depths.data() + last + 1);
+    }
+
+    unsigned int minimum = std::min(
+        *std::min_element(_depths.data() + first, _depths.data() + (firstBlock + 1) * PATH_INDEX_BLOCK_SIZE),
+        *std::min_element(_depths.data() + lastBlock * PATH_INDEX_BLOCK_SIZE, _depths.data() + last + 1)
+    );
+
+    if (firstBlock + 1 < lastBlock) {
+        const unsigned int count = lastBlock - firstBlock - 1;
+        const unsigned int level = std::bit_width(count) - 1;
+        const uint32_t *row = _table.data() + static_cast<size_t>(level) * _blocks;
+        minimum = std::min({minimum, row[firstBlock + 1], row[lastBlock - (1u << level)]});
+    }
+    return minimum;
+}
+
+// The shallowest cell after a and up to b in preorder is a child of their lowest common ancestor.
+unsigned int PathIndex::distance(const unsigned int a, const unsigned int b) const {
+    if (a == b) {
+        return 0;
+    }
+
+    const auto [first, last] = std::minmax(_order[a], _order[b]);
+    const unsigned int ancestorDepth = minimumDepth(first, last - 1) - 1;
+    return depth(a) + depth(b) - 2 * ancestorDepth;
+}
+
+// The parent is the only connected neighbor one level higher.
+unsigned int PathIndex::parent(const unsigned int cell) const {
+    const unsigned int x = cell % _width, y = cell / _width, height = _size / _width, parentDepth = depth(cell) - 1;
+    if (x != 0 && _maze.isConnectedRight(x - 1, y) && depth(cell - 1) == parentDepth) {
+        return cell - 1;
+    }
+    if (x + 1 != _width && _maze.isConnectedRight(x, y) && depth(cell + 1) == parentDepth) {
+        return cell + 1;
+    }
+    if (y != 0 && _maze.isConnectedDown(x, y - 1) && depth(cell - _width) == parentDepth) {
+        return cell - _width;
+    }
+    if (y + 1 != height && _maze.isConnectedDown(x, y) && depth(cell + _width) == parentDepth) {
+        return cell + _width;
+    }
+    throw std::invalid_argument("The cell " + std::to_string(cell) + " has no parent");
+}
+
+std::vector<unsigned int> PathIndex::path(unsigned int a, unsigned int b) const {
+    const unsigned int ancestorDepth = (depth(a) + depth(b) - distance(a, b)) / 2;
+
+    std::vector<unsigned int> path, tail;
+    path.reserve(depth(a) - ancestorDepth + 1);
+    tail.reserve(depth(b) - ancestorDepth);
+
+    for (; depth(a) > ancestorDepth; a = parent(a)) {
+        path.push_back(a);
+    }
+    for (; depth(b) > ancestorDepth; b = parent(b)) {
+        tail.push_back(b);
+    }
+    path.push_back(a);
+    path.insert(path.end(), tail.rbegin(), tail.rend());
+    return path;
+}
+
+std::vector<unsigned int> PathIndex::distances(const std::vector<std::pair<unsigned int, unsigned int>> &queries, const int threads) const {
+    std::vector<unsigned int> results(queries.size());
+    const auto batches = static_cast<unsigned int>((queries.size() + PATH_INDEX_QUERY_BATCH - 1) / PATH_INDEX_QUERY_BATCH);
+
+    parallelFor(batches, threads, [&](const unsigned int batch) {
+        const size_t first = static_cast<size_t>(batch) * PATH_INDEX_QUERY_BATCH, last = std::min(first + PATH_INDEX_QUERY_BATCH, queries.size());
+        for (size_t i = first; i < last; i++) {
+            results[i] = distance(queries[i].first, queries[i].second);
+        }
+    });
+    return results;
+}
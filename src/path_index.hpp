@@ -0,0 +1,76 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef PATH_INDEX_HPP
+#define PATH_INDEX_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "arena.hpp"
+#include "maze.hpp"
+
+constexpr unsigned int PATH_INDEX_BLOCK_SIZE = 64;
+
+// Answers distance queries between cells of a perfect maze in constant time, and path queries in time linear in the path.
+// Cells are numbered in depth-first preorder from the first cell. The lowest common ancestor of two cells is then the parent
+// of the shallowest cell between them in that order, found with a sparse table over blocks of depths and a scan of two blocks.
+// Cells are identified by their position: y * width + x.
+class PathIndex {
+    public:
+
+    // Throws std::invalid_argument when the maze is not a tree, that is when it has loops or unreachable cells,
+    // and std::length_error when it has more than MAZE_MAX_INDEXED_CELLS cells.
+    explicit PathIndex(const Maze &maze, int threads = 0);
+
+    [[nodiscard]] unsigned int depth(unsigned int cell) const;
+
+    [[nodiscard]] unsigned int distance(unsigned int a, unsigned int b) const;
+
+    // Cells from a to b, both included.
+    [[nodiscard]] std::vector<unsigned int> path(unsigned int a, unsigned int b) const;
+
+    [[nodiscard]] std::vector<unsigned int> distances(const std::vector<std::pair<unsigned int, unsigned int>> &queries, int threads = 0) const;
+
+    private:
+
+    void buildOrder();
+
+    void buildTable(int threads);
+
+    [[nodiscard]] unsigned int minimumDepth(unsigned int first, unsigned int last) const;
+
+    [[nodiscard]] unsigned int parent(unsigned int cell) const;
+
+    const Maze &_maze;
+    const unsigned int _width, _size;
+
+    // Preorder index of each cell, and depth of the cell at each preorder index.
+    ZeroedArray<uint32_t> _order{}, _depths{};
+
+    // Level k holds the minimum depth of 2^k consecutive blocks starting at each block.
+    unsigned int _blocks = 0;
+    std::vector<uint32_t> _table{};
+};
+
+
+#endif //PATH_INDEX_HPP
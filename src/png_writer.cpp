@@ -0,0 +1,285 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "png_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+
+#include "parallel.hpp"
+
+constexpr std::array<uint8_t, 8> PNG_SIGNATURE = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+constexpr size_t PNG_CHUNK_SIZE = 1 << 16;
+
+constexpr uint8_t FILTER_NONE = 0;
+constexpr uint8_t FILTER_UP = 2;
+
+constexpr size_t ADLER32_BASE = 65521;
+
+void writeUInt32(uint8_t *out, const uint32_t value) {
+    out[0] = value >> 24;
+    out[1] = value >> 16;
+    out[2] = value >> 8;
+    out[3] = value;
+}
+
+// The zlib stream is assembled by hand around raw deflate data so that independently compressed segments can be joined.
+std::array<uint8_t, 2> zlibHeader(const int compressionLevel) {
+    const int level = compressionLevel == Z_DEFAULT_COMPRESSION ? 6 : compressionLevel;
+    const int flags = (level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6;
+    constexpr int method = 0x78; // deflate, 32K window
+    return {method, static_cast<uint8_t>(flags + 31 - (method * 256 + flags) % 31)};
+}
+
+struct DeflateSegment {
+    std::vector<uint8_t> data;
+    uLong adler;
+    size_t size;
+};
+
+// Segments may exceed the range of z_off_t, which has 32 bits on some platforms.
+uLong combineAdler32(const uLong adler1, const uLong adler2, const size_t size2) {
+#if defined(Z_LARGE64) || defined(Z_WANT64)
+    return adler32_combine64(adler1, adler2, static_cast<z_off64_t>(size2));
+#else
+    // Only the length modulo the Adler-32 base is used, which always fits.
+    return adler32_combine(adler1, adler2, static_cast<z_off_t>(size2 % ADLER32_BASE));
+#endif
+}
+
+// Compresses a block on its own, ending with a sync flush so that the next segment starts on a byte boundary.
+bool compressBlock(const ScanlineBlock &block, const int compressionLevel, DeflateSegment &segment) {
+    const size_t lineSize = block.lineSize();
+    std::vector<uint8_t> row(lineSize + 1), repeatedRow(lineSize + 1, 0), buffer(PNG_CHUNK_SIZE);
+    row[0] = FILTER_NONE;
+    repeatedRow[0] = FILTER_UP;
+
+    z_stream stream{};
+    if (deflateInit2(&stream, compressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    segment.data.clear();
+    segment.adler = adler32(0, nullptr, 0);
+    segment.size = 0;
+
+    const auto compress = [&](const uint8_t *data, const size_t size, const int flush) {
+        stream.next_in = const_cast<Bytef *>(data);
+        stream.avail_in = static_cast<uInt>(size);
+        do {
+            stream.next_out = buffer.data();
+            stream.avail_out = static_cast<uInt>(buffer.size());
+            deflate(&stream, flush);
+            segment.data.insert(segment.data.end(), buffer.data(), buffer.data() + (buffer.size() - stream.avail_out));
+        } while (stream.avail_out == 0);
+
+        if (size != 0) {
+            segment.adler = adler32(segment.adler, data, static_cast<uInt>(size));
+            segment.size += size;
+        }
+    };
+
+    for (size_t i = 0; i < block.lineCount(); i++) {
+        std::memcpy(row.data() + 1, block.line(i), lineSize);
+        compress(row.data(), row.size(), Z_NO_FLUSH);
+        for (int j = 1; j < block.repetitions(i); j++) {
+            compress(repeatedRow.data(), repeatedRow.size(), Z_NO_FLUSH);
+        }
+    }
+    compress(nullptr, 0, Z_SYNC_FLUSH);
+
+    deflateEnd(&stream);
+    return true;
+}
+
+PngWriter::PngWriter(const QString &fileName, const int compressionLevel, const int threads) :
+    _file(std::make_unique<QSaveFile>(fileName)), _device(*_file), _compressionLevel(compressionLevel), _threads(threads), _adler(adler32(0, nullptr, 0)) {}
+
+PngWriter::PngWriter(QIODevice &device, const int compressionLevel, const int threads) :
+    _device(device), _compressionLevel(compressionLevel), _threads(threads), _adler(adler32(0, nullptr, 0)) {}
+
+PngWriter::~PngWriter() {
+    if (_initialized) {
+        deflateEnd(&_stream);
+    }
+}
+
+bool PngWriter::open(const uint64_t width, const uint64_t height, const int bitDepth) {
+    if (width > PNG_MAX_DIMENSION || height > PNG_MAX_DIMENSION) {
+        return false;
+    }
+
+    if (_file != nullptr && !_file->open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    if (deflateInit2(&_stream, _compressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        cancel();
+        return false;
+    }
+    _initialized = true;
+
+    _lineSize = (static_cast<size_t>(width) * bitDepth + 7) / 8;
+    _row.resize(_lineSize + 1);
+    _repeatedRow.assign(_lineSize + 1, 0);
+    _repeatedRow[0] = FILTER_UP;
+    _buffer.resize(PNG_CHUNK_SIZE);
+    _data.reserve(PNG_CHUNK_SIZE);
+
+    _device.write(reinterpret_cast<const char *>(PNG_SIGNATURE.data()), PNG_SIGNATURE.size());
+
+    std::array<uint8_t, 13> header{};
+    writeUInt32(header.data(), static_cast<uint32_t>(width));
+    writeUInt32(header.data() + 4, static_cast<uint32_t>(height));
+    header[8] = bitDepth;
+    header[9] = 0; // grayscale
+    writeChunk("IHDR", header.data(), header.size());
+
+    const std::array<uint8_t, 2> zlib = zlibHeader(_compressionLevel);
+    writeData(zlib.data(), zlib.size());
+
+    return !_failed;
+}
+
+// The first scanline of a repetition is stored as is, the next ones use the Up filter:
+// they are identical to the line above, so their filtered row is all zeros and is shared.
+void PngWriter::writeLines(const uint8_t *line, const int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    _row[0] = FILTER_NONE;
+    std::memcpy(_row.data() + 1, line, _lineSize);
+    compress(_row.data(), _row.size(), Z_NO_FLUSH);
+
+    for (int i = 1; i < count; i++) {
+        compress(_repeatedRow.data(), _repeatedRow.size(), Z_NO_FLUSH);
+    }
+    _pending = true;
+}
+
+// Blocks are compressed concurrently into separate deflate segments that are then appended in order.
+void PngWriter::writeBlocks(const std::vector<ScanlineBlock> &blocks, const size_t count) {
+    if (_pending) {
+        compress(nullptr, 0, Z_SYNC_FLUSH);
+        deflateReset(&_stream);
+        _pending = false;
+    }
+
+    std::vector<DeflateSegment> segments(count);
+    std::atomic<bool> failed{false};
+    parallelFor(static_cast<unsigned int>(count), _threads, [&](const unsigned int index) {
+        if (!compressBlock(blocks[index], _compressionLevel, segments[index])) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+    });
+
+    if (failed.load(std::memory_order_relaxed)) {
+        _failed = true;
+        return;
+    }
+
+    for (const DeflateSegment &segment : segments) {
+        writeData(segment.data.data(), segment.data.size());
+        _adler = combineAdler32(_adler, segment.adler, segment.size);
+    }
+}
+
+bool PngWriter::finish() {
+    compress(nullptr, 0, Z_FINISH);
+
+    std::array<uint8_t, 4> adler{};
+    writeUInt32(adler.data(), static_cast<uint32_t>(_adler));
+    writeData(adler.data(), adler.size());
+    flushData();
+
+    writeChunk("IEND", nullptr, 0);
+
+    if (_failed) {
+        cancel();
+        return false;
+    }
+    return _file == nullptr || _file->commit();
+}
+
+void PngWriter::cancel() {
+    if (_file != nullptr) {
+        _file->cancelWriting();
+    }
+}
+
+void PngWriter::compress(const uint8_t *data, const size_t size, const int flush) {
+    _stream.next_in = const_cast<Bytef *>(data);
+    _stream.avail_in = static_cast<uInt>(size);
+
+    do {
+        _stream.next_out = _buffer.data();
+        _stream.avail_out = static_cast<uInt>(_buffer.size());
+        deflate(&_stream, flush);
+        writeData(_buffer.data(), _buffer.size() - _stream.avail_out);
+    } while (_stream.avail_out == 0);
+
+    if (size != 0) {
+        _adler = adler32(_adler, data, static_cast<uInt>(size));
+    }
+}
+
+void PngWriter::writeData(const uint8_t *data, size_t size) {
+    while (size != 0) {
+        const size_t length = std::min(size, PNG_CHUNK_SIZE - _data.size());
+        _data.insert(_data.end(), data, data + length);
+        data += length;
+        size -= length;
+
+        if (_data.size() == PNG_CHUNK_SIZE) {
+            flushData();
+        }
+    }
+}
+
+void PngWriter::flushData() {
+    if (!_data.empty()) {
+        writeChunk("IDAT", _data.data(), _data.size());
+        _data.clear();
+    }
+}
+
+void PngWriter::writeChunk(const char *type, const uint8_t *data, const size_t size) {
+    std::array<uint8_t, 8> header{};
+    writeUInt32(header.data(), static_cast<uint32_t>(size));
+    std::memcpy(header.data() + 4, type, 4);
+
+    uLong crc = crc32(0, header.data() + 4, 4);
+    if (size != 0) {
+        crc = crc32(crc, data, static_cast<uInt>(size));
+    }
+    std::array<uint8_t, 4> footer{};
+    writeUInt32(footer.data(), static_cast<uint32_t>(crc));
+
+    if (_device.write(reinterpret_cast<const char *>(header.data()), header.size()) != header.size()
+        || (size != 0 && _device.write(reinterpret_cast<const char *>(data), static_cast<qint64>(size)) != static_cast<qint64>(size))
+        || _device.write(reinterpret_cast<const char *>(footer.data()), footer.size()) != footer.size()) {
+        _failed = true;
+    }
+}
@@ -0,0 +1,80 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef PNG_WRITER_HPP
+#define PNG_WRITER_HPP
+
+#include <QSaveFile>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <zlib.h>
+#include "scanline.hpp"
+
+// The PNG format stores the dimensions of an image on 31 bits.
+constexpr uint64_t PNG_MAX_DIMENSION = 0x7FFFFFFF;
+
+// Writes a grayscale PNG while its scanlines are produced, so only one band is kept in memory.
+// When writing to a file, it is written to a temporary location and only replaces the destination when finished.
+class PngWriter : public ScanlineSink {
+    public:
+
+    explicit PngWriter(const QString &fileName, int compressionLevel = Z_DEFAULT_COMPRESSION, int threads = 1);
+
+    explicit PngWriter(QIODevice &device, int compressionLevel = Z_DEFAULT_COMPRESSION, int threads = 1);
+
+    ~PngWriter() override;
+
+    // Fails when a dimension exceeds PNG_MAX_DIMENSION.
+    bool open(uint64_t width, uint64_t height, int bitDepth = 1);
+
+    void writeLines(const uint8_t *line, int count) override;
+
+    void writeBlocks(const std::vector<ScanlineBlock> &blocks, size_t count) override;
+
+    bool finish();
+
+    void cancel();
+
+    private:
+
+    void compress(const uint8_t *data, size_t size, int flush);
+
+    void writeData(const uint8_t *data, size_t size);
+
+    void flushData();
+
+    void writeChunk(const char *type, const uint8_t *data, size_t size);
+
+    std::unique_ptr<QSaveFile> _file;
+    QIODevice &_device;
+    int _compressionLevel, _threads;
+
+    z_stream _stream{};
+    bool _initialized = false, _pending = false, _failed = false;
+    uLong _adler;
+
+    size_t _lineSize = 0;
+    std::vector<uint8_t> _row{}, _repeatedRow{}, _buffer{}, _data{};
+};
+
+#endif //PNG_WRITER_HPP
@@ -0,0 +1,58 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "progress.hpp"
+
+#include <algorithm>
+
+const char* stageName(const ProgressStage stage) {
+    switch (stage) {
+        case IDLE:
+            return "Initializing ...";
+        case FILLING:
+            return "Filling points ...";
+        case SHUFFLING:
+            return "Shuffling directions ...";
+        case CONNECTING:
+            return "Connecting points ...";
+        case JOINING:
+            return "Joining tiles ...";
+        case ERRORS:
+            return "Adding errors ...";
+        case RENDERING:
+            return "Generating image ...";
+        case STREAMING_ROWS:
+            return "Generating maze and image ...";
+        case TILING:
+            return "Generating tiles ...";
+    }
+    return "";
+}
+
+int Progress::value() const {
+    const uint64_t total = _total.load(std::memory_order_relaxed);
+    if (total == 0) {
+        return 0;
+    }
+    const uint64_t done = std::min(_done.load(std::memory_order_relaxed), total);
+    return static_cast<int>(static_cast<double>(done) / static_cast<double>(total) * PROGRESS_MAX);
+}
@@ -0,0 +1,83 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef PROGRESS_HPP
+#define PROGRESS_HPP
+
+#include <atomic>
+#include <cstdint>
+
+enum ProgressStage {IDLE, FILLING, SHUFFLING, CONNECTING, JOINING, ERRORS, RENDERING, STREAMING_ROWS, TILING};
+
+const char* stageName(ProgressStage stage);
+
+constexpr int PROGRESS_MAX = 1000;
+constexpr uint64_t PROGRESS_BATCH = 4096;
+
+// Progress of a task shared between the thread doing the work and the threads polling it.
+// Counters are relaxed atomics: a poll may briefly see the new stage with the previous counts, which only affects display.
+class Progress {
+    public:
+
+    void start(ProgressStage stage, uint64_t total) {
+        _done.store(0, std::memory_order_relaxed);
+        _total.store(total, std::memory_order_relaxed);
+        _stage.store(stage, std::memory_order_relaxed);
+    }
+
+    // Publishes the number of completed steps once every PROGRESS_BATCH steps, even when the count jumps over a multiple.
+    void update(const uint64_t done) {
+        if (done / PROGRESS_BATCH != _done.load(std::memory_order_relaxed) / PROGRESS_BATCH) {
+            _done.store(done, std::memory_order_relaxed);
+        }
+    }
+
+    void add(const uint64_t count) {
+        _done.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void finish() {
+        _done.store(_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] ProgressStage stage() const {
+        return _stage.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] int value() const;
+
+    void cancel() {
+        _cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool isCancelled() const {
+        return _cancelled.load(std::memory_order_relaxed);
+    }
+
+    private:
+
+    std::atomic<ProgressStage> _stage{IDLE};
+    std::atomic<uint64_t> _done{0}, _total{0};
+    std::atomic<bool> _cancelled{false};
+};
+
+#endif //PROGRESS_HPP
@@ -0,0 +1,327 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+// Identifies how a seed is turned into a maze: the generator and the way bounded integers are drawn from it.
+// An id never changes meaning, any change of either gets a new id so existing seeds keep producing the same mazes.
+// The v2 ids use the same generators as v1 but draw the loops of the maze directly among its closed walls.
+enum RandomAlgorithm {MT19937, XOSHIRO256_V1, PCG64_V1, SPLITMIX64_V1, XOSHIRO256_V2, PCG64_V2, SPLITMIX64_V2};
+
+constexpr RandomAlgorithm RANDOM_ALGORITHMS[] = {MT19937, XOSHIRO256_V1, PCG64_V1, SPLITMIX64_V1, XOSHIRO256_V2, PCG64_V2, SPLITMIX64_V2};
+
+const char* randomAlgorithmName(RandomAlgorithm algorithm);
+
+class SplitMix64 {
+    public:
+
+    typedef uint64_t result_type;
+
+    explicit SplitMix64(const uint64_t seed) : _state(seed) {}
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        uint64_t z = _state += 0x9e3779b97f4a7c15;
+        z = (z ^ z >> 30) * 0xbf58476d1ce4e5b9;
+        z = (z ^ z >> 27) * 0x94d049bb133111eb;
+        return z ^ z >> 31;
+    }
+
+    private:
+
+    uint64_t _state;
+};
+
+// xoshiro256** by Blackman and Vigna, seeded through SplitMix64 as recommended by its authors.
+class Xoshiro256 {
+    public:
+
+    typedef uint64_t result_type;
+
+    explicit Xoshiro256(const uint64_t seed) {
+        SplitMix64 seeder(seed);
+        for (uint64_t &s : _state) {
+            s = seeder();
+        }
+    }
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        const uint64_t result = rotate(_state[1] * 5, 7) * 9;
+        const uint64_t t = _state[1] << 17;
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = rotate(_state[3], 45);
+        return result;
+    }
+
+    private:
+
+    static uint64_t rotate(const uint64_t x, const int k) {
+        return x << k | x >> (64 - k);
+    }
+
+    uint64_t _state[4];
+};
+
+// PCG64 (XSL RR 128/64) by O'Neill, seeded through SplitMix64.
+class Pcg64 {
+    public:
+
+    typedef uint64_t result_type;
+
+    explicit Pcg64(const uint64_t seed) {
+        SplitMix64 seeder(seed);
+        _state = static_cast<unsigned __int128>(seeder()) << 64 | seeder();
+        _increment = (static_cast<unsigned __int128>(seeder()) << 64 | seeder()) | 1;
+    }
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        _state = _state * MULTIPLIER + _increment;
+        const auto value = static_cast<uint64_t>(_state >> 64) ^ static_cast<uint64_t>(_state);
+        const auto rotation = static_cast<int>(_state >> 122);
+        return value >> rotation | value << (-rotation & 63);
+    }
+
+    private:
+
+    static constexpr unsigned __int128 MULTIPLIER = static_cast<unsigned __int128>(2549297995355413924) << 64 | 4865540595714422341;
+
+    unsigned __int128 _state, _increment;
+};
+
+// Marks the generator of a v2 algorithm, which produces the same numbers.
+template <typename Generator>
+class LoopSampling : public Generator {
+    public:
+
+    using Generator::Generator;
+};
+
+template <typename Generator>
+constexpr bool SAMPLES_LOOPS = false;
+
+template <typename Generator>
+constexpr bool SAMPLES_LOOPS<LoopSampling<Generator>> = true;
+
+// Uniform integer in [0, bound) using Lemire's nearly divisionless method on the high 32 bits of a 64-bit output.
+template <typename Generator>
+uint32_t randomBelow(Generator &generator, const uint32_t bound) {
+    uint64_t product = (generator() >> 32) * bound;
+    if (auto low = static_cast<uint32_t>(product); low < bound) {
+        const uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = (generator() >> 32) * bound;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+// The original generator keeps drawing through the standard distribution, which mazes made before were generated with.
+inline uint32_t randomBelow(std::mt19937 &generator, const uint32_t bound) {
+    std::uniform_int_distribution<uint32_t> distribution(0, bound - 1);
+    return distribution(generator);
+}
+
+// Uniform integer in [0, bound) for bounds beyond 32 bits, drawn by rejection of the smallest covering power of two.
+// Bounds that fit 32 bits draw exactly as randomBelow, so smaller mazes keep their results.
+template <typename Generator>
+uint64_t randomBelow64(Generator &generator, const uint64_t bound) {
+    if (bound <= std::numeric_limits<uint32_t>::max()) {
+        return randomBelow(generator, static_cast<uint32_t>(bound));
+    }
+    const uint64_t mask = ~uint64_t{0} >> std::countl_zero(bound - 1);
+    uint64_t value;
+    do {
+        value = generator() & mask;
+    } while (value >= bound);
+    return value;
+}
+
+inline uint64_t randomBelow64(std::mt19937 &generator, const uint64_t bound) {
+    if (bound <= std::numeric_limits<uint32_t>::max()) {
+        return randomBelow(generator, static_cast<uint32_t>(bound));
+    }
+    std::uniform_int_distribution<uint64_t> distribution(0, bound - 1);
+    return distribution(generator);
+}
+
+// 64 random bits, from one or two outputs of the generator.
+template <typename Generator>
+uint64_t randomWord(Generator &generator) {
+    if constexpr (Generator::max() == std::numeric_limits<uint64_t>::max()) {
+        return generator();
+    } else {
+        const uint64_t high = generator();
+        return high << 32 | static_cast<uint32_t>(generator());
+    }
+}
+
+// Fair coin flips, taken one by one from the bits of random words.
+template <typename Generator>
+class RandomCoin {
+    public:
+
+    explicit RandomCoin(Generator &generator) : _generator(generator) {}
+
+    bool operator()() {
+        if (_count == 0) {
+            _bits = randomWord(_generator);
+            _count = 64;
+        }
+        const bool result = _bits & 1;
+        _bits >>= 1;
+        _count--;
+        return result;
+    }
+
+    private:
+
+    Generator &_generator;
+    uint64_t _bits = 0;
+    unsigned int _count = 0;
+};
+
+// True with the given probability: 53 random bits are compared with the probability in 53-bit fixed point.
+template <typename Generator>
+class RandomChance {
+    public:
+
+    RandomChance(Generator &generator, const double probability) :
+        _generator(generator), _threshold(static_cast<uint64_t>(std::ldexp(probability, 53))) {}
+
+    bool operator()() {
+        return randomWord(_generator) >> 11 < _threshold;
+    }
+
+    private:
+
+    Generator &_generator;
+    uint64_t _threshold;
+};
+
+// The original generator keeps drawing through the standard distribution, like randomBelow.
+template <>
+class RandomChance<std::mt19937> {
+    public:
+
+    RandomChance(std::mt19937 &generator, const double probability) : _generator(generator), _distribution(probability) {}
+
+    bool operator()() {
+        return _distribution(_generator);
+    }
+
+    private:
+
+    std::mt19937 &_generator;
+    std::bernoulli_distribution _distribution;
+};
+
+template <>
+class RandomCoin<std::mt19937> : public RandomChance<std::mt19937> {
+    public:
+
+    explicit RandomCoin(std::mt19937 &generator) : RandomChance(generator, 0.5) {}
+};
+
+// Generator of one tile of the tiled engine, derived from a value of the main generator and the tile index.
+template <typename Generator>
+Generator makeTileGenerator(const typename Generator::result_type seed, const uint32_t tile) {
+    SplitMix64 mixer(seed ^ static_cast<uint64_t>(tile) << 32);
+    return Generator(mixer());
+}
+
+template <>
+inline std::mt19937 makeTileGenerator<std::mt19937>(const std::mt19937::result_type seed, const uint32_t tile) {
+    std::seed_seq seedSequence{static_cast<uint32_t>(seed), tile};
+    return std::mt19937(seedSequence);
+}
+
+// Calls the function with a generator of the given algorithm seeded with the given seed.
+template <typename Function>
+decltype(auto) withGenerator(const RandomAlgorithm algorithm, const int seed, Function &&function) {
+    switch (algorithm) {
+        case XOSHIRO256_V1: {
+            Xoshiro256 generator(static_cast<uint32_t>(seed));
+            return function(generator);
+        }
+        case PCG64_V1: {
+            Pcg64 generator(static_cast<uint32_t>(seed));
+            return function(generator);
+        }
+        case SPLITMIX64_V1: {
+            SplitMix64 generator(static_cast<uint32_t>(seed));
+            return function(generator);
+        }
+        case XOSHIRO256_V2: {
+            LoopSampling<Xoshiro256> generator(static_cast<uint32_t>(seed));
+            return function(generator);
+        }
+        case PCG64_V2: {
+            LoopSampling<Pcg64> generator(static_cast<uint32_t>(seed));
+            return function(generator);
+        }
+        case SPLITMIX64_V2: {
+            LoopSampling<SplitMix64> generator(static_cast<uint32_t>(seed));
+            return function(generator);
+        }
+        default: {
+            std::mt19937 generator(seed);
+            return function(generator);
+        }
+    }
+}
+
+#endif //RANDOM_HPP
@@ -0,0 +1,123 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef RANDOM_PERMUTATION_HPP
+#define RANDOM_PERMUTATION_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include "random_queue.hpp"
+#include "vector_util.hpp"
+
+constexpr int PERMUTATION_ROUNDS = 4;
+
+// Visits every value of [0, size) once per pass, in a new random order each pass, without storing the order.
+// A Feistel network keyed from the generator is a bijection over [0, 4^k) with 4^k >= size.
+// Values outside [0, size) are sent through the network again until they fall inside (cycle walking).
+template <typename Generator>
+class RandomPermutation {
+
+    public:
+
+    RandomPermutation(const uint64_t size, Generator &generator) : _size(size), _generator(generator), _index(size) {
+        _halfBits = (std::bit_width(size > 1 ? size - 1 : 1) + 1) / 2;
+        _halfMask = (uint64_t{1} << _halfBits) - 1;
+    };
+
+    void reset() {
+        _index = _size;
+    }
+
+    uint64_t next() {
+        if (_index == _size) {
+            for (uint64_t &key : _keys) {
+                key = _generator();
+            }
+            _index = 0;
+        }
+
+        uint64_t value = permute(_index++);
+        while (value >= _size) {
+            value = permute(value);
+        }
+        return value;
+    }
+
+    private:
+
+    [[nodiscard]] uint64_t permute(const uint64_t value) const {
+        uint64_t left = value >> _halfBits, right = value & _halfMask;
+        for (const uint64_t key : _keys) {
+            const uint64_t next = left ^ (mix(right ^ key) & _halfMask);
+            left = right;
+            right = next;
+        }
+        return left << _halfBits | right;
+    }
+
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ z >> 30) * 0xbf58476d1ce4e5b9;
+        z = (z ^ z >> 27) * 0x94d049bb133111eb;
+        return z ^ z >> 31;
+    }
+
+    uint64_t _size;
+    Generator &_generator;
+    unsigned int _halfBits;
+    uint64_t _halfMask;
+    std::array<uint64_t, PERMUTATION_ROUNDS> _keys{};
+    uint64_t _index;
+};
+
+// Random order over [0, size), repeated as many times as needed.
+template <typename Generator>
+RandomPermutation<Generator> randomOrder(const uint64_t size, Generator &generator) {
+    return RandomPermutation<Generator>(size, generator);
+}
+
+// The original generator keeps the materialized queue its mazes were generated with, of 32-bit values while they fit.
+inline RandomQueue<uint32_t> randomOrder(const uint32_t size, std::mt19937 &generator) {
+    return RandomQueue(sequence(size), generator);
+}
+
+inline RandomQueue<uint64_t> randomOrder(const uint64_t size, std::mt19937 &generator) {
+    return RandomQueue(sequence(size), generator);
+}
+
+// Visits the random order of a 64-bit size, stored on 32 bits by the original generator while it fits.
+template <typename Generator, typename Visit>
+void visitRandomOrder(const uint64_t size, Generator &generator, const Visit &visit) {
+    if constexpr (std::is_same_v<Generator, std::mt19937>) {
+        if (size <= UINT32_MAX) {
+            auto order = randomOrder(static_cast<uint32_t>(size), generator);
+            visit(order);
+            return;
+        }
+    }
+    auto order = randomOrder(size, generator);
+    visit(order);
+}
+
+#endif //RANDOM_PERMUTATION_HPP
@@ -23,14 +23,17 @@
 #ifndef RANDOM_QUEUE_HPP
 #define RANDOM_QUEUE_HPP
 
+#include <cstdint>
+#include <utility>
 #include <vector>
+#include "random.hpp"
 
-template <typename T>
+template <typename T, typename Generator = std::mt19937>
 class RandomQueue {
 
     public:
 
-    RandomQueue(std::vector<T> values, std::mt19937 &generator) : _values(values), _generator(generator), _remainingSize(0) {};
+    RandomQueue(std::vector<T> values, Generator &generator) : _values(std::move(values)), _generator(generator), _remainingSize(0) {};
 
     void reset() {
         _remainingSize = 0;
@@ -41,8 +44,7 @@ class RandomQueue {
             _remainingSize = _values.size();
         }
         _remainingSize--;
-        std::uniform_int_distribution distribution(0, _remainingSize);
-        int index = distribution(_generator);
+        const auto index = static_cast<size_t>(randomBelow64(_generator, _remainingSize + 1));
         T value = _values[index];
         _values[index] = _values[_remainingSize];
         _values[_remainingSize] = value;
@@ -52,8 +54,8 @@ class RandomQueue {
     private:
 
     std::vector<T> _values;
-    std::mt19937 &_generator;
-    int _remainingSize;
+    Generator &_generator;
+    uint64_t _remainingSize;
 };
 
 #endif //RANDOM_QUEUE_HPP
@@ -0,0 +1,67 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "renderer.hpp"
+
+#include <cstring>
+#include <utility>
+
+Renderer::Renderer(const unsigned int width, const int pathSize, const int wallSize, ScanlineSink &sink) :
+    _pathSize(pathSize), _wallSize(wallSize),
+    _builder(width, pathSize, wallSize),
+    _pathLine(_builder.lineSize()), _wallLine(_builder.lineSize()),
+    _sink(sink) {}
+
+void Renderer::renderTop() {
+    const std::vector<uint8_t> black(_builder.lineSize(), 0);
+    _sink.writeLines(black.data(), _wallSize);
+}
+
+// Each row of cells is made of pathSize identical path scanlines followed by wallSize identical wall scanlines,
+// so both are built once and then repeated by the sink.
+void Renderer::renderRow(const uint64_t *right, const uint64_t *down) {
+    _builder.buildPathLine(right, _pathLine.data());
+    _sink.writeLines(_pathLine.data(), _pathSize);
+
+    _builder.buildWallLine(down, _wallLine.data());
+    _sink.writeLines(_wallLine.data(), _wallSize);
+}
+
+ImageSink::ImageSink(const unsigned int width, const unsigned int height) : _image(static_cast<int>(width), static_cast<int>(height), QImage::Format_Mono) {
+    _image.setColorCount(2);
+    _image.setColor(0, qRgb(0, 0, 0));
+    _image.setColor(1, qRgb(255, 255, 255));
+}
+
+void ImageSink::writeLines(const uint8_t *line, const int count) {
+    const size_t size = (_image.width() + 7) / 8;
+    const auto padding = static_cast<size_t>(_image.bytesPerLine()) - size;
+    for (int i = 0; i < count; i++) {
+        uchar *scanLine = _image.scanLine(_y++);
+        std::memcpy(scanLine, line, size);
+        std::memset(scanLine + size, 0, padding);
+    }
+}
+
+QImage ImageSink::finish() {
+    return std::move(_image);
+}
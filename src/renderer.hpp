@@ -0,0 +1,64 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include <QImage>
+#include <cstdint>
+#include <vector>
+#include "scanline.hpp"
+
+class Renderer {
+    public:
+
+    Renderer(unsigned int width, int pathSize, int wallSize, ScanlineSink &sink);
+
+    void renderTop();
+
+    void renderRow(const uint64_t *right, const uint64_t *down);
+
+    private:
+
+    int _pathSize, _wallSize;
+
+    ScanlineBuilder _builder;
+    std::vector<uint8_t> _pathLine, _wallLine;
+    ScanlineSink &_sink;
+};
+
+class ImageSink : public ScanlineSink {
+    public:
+
+    ImageSink(unsigned int width, unsigned int height);
+
+    void writeLines(const uint8_t *line, int count) override;
+
+    [[nodiscard]] QImage finish();
+
+    private:
+
+    QImage _image;
+    int _y = 0;
+};
+
+#endif //RENDERER_HPP
@@ -0,0 +1,249 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "scanline.hpp"
+
+#include <algorithm>
+#include <array>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SCANLINE_BMI2
+#endif
+
+uint64_t pixelSize(const uint64_t cells, const int pathSize, const int wallSize) {
+    return cells * pathSize + (cells + 1) * wallSize;
+}
+
+void ScanlineSink::writeBlocks(const std::vector<ScanlineBlock> &blocks, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const ScanlineBlock &block = blocks[i];
+        for (size_t j = 0; j < block.lineCount(); j++) {
+            writeLines(block.line(j), block.repetitions(j));
+        }
+    }
+}
+
+ScanlineBlock::ScanlineBlock(const size_t lineSize) : _lineSize(lineSize) {}
+
+void ScanlineBlock::writeLines(const uint8_t *line, const int count) {
+    if (count <= 0) {
+        return;
+    }
+    _lines.insert(_lines.end(), line, line + _lineSize);
+    _repetitions.push_back(count);
+}
+
+void ScanlineBlock::clear() {
+    _lines.clear();
+    _repetitions.clear();
+}
+
+size_t ScanlineBlock::lineSize() const {
+    return _lineSize;
+}
+
+size_t ScanlineBlock::lineCount() const {
+    return _repetitions.size();
+}
+
+const uint8_t* ScanlineBlock::line(const size_t index) const {
+    return _lines.data() + index * _lineSize;
+}
+
+int ScanlineBlock::repetitions(const size_t index) const {
+    return _repetitions[index];
+}
+
+constexpr std::array<uint8_t, 256> computeReversedBytes() {
+    std::array<uint8_t, 256> reversed{};
+    for (int i = 0; i < 256; i++) {
+        int r = 0;
+        for (int b = 0; b < 8; b++) {
+            r |= (i >> b & 1) << (7 - b);
+        }
+        reversed[i] = static_cast<uint8_t>(r);
+    }
+    return reversed;
+}
+
+constexpr std::array<uint8_t, 256> REVERSED_BYTES = computeReversedBytes();
+
+// Appends bits to a buffer, least significant bit first.
+class BitWriter {
+    public:
+
+    explicit BitWriter(uint64_t *out) : _out(out) {}
+
+    void write(const uint64_t bits, const unsigned int count) {
+        _accumulator |= bits << _count;
+        if (_count + count >= 64) {
+            *_out++ = _accumulator;
+            _accumulator = _count == 0 ? 0 : bits >> (64 - _count);
+            _count = _count + count - 64;
+        } else {
+            _count += count;
+        }
+    }
+
+    void writeRun(const bool value, unsigned int count) {
+        while (count >= 64) {
+            write(value ? ~uint64_t{0} : 0, 64);
+            count -= 64;
+        }
+        if (count != 0) {
+            write(value ? (uint64_t{1} << count) - 1 : 0, count);
+        }
+    }
+
+    void flush() {
+        if (_count != 0) {
+            *_out++ = _accumulator;
+        }
+        _accumulator = 0;
+        _count = 0;
+    }
+
+    private:
+
+    uint64_t *_out;
+    uint64_t _accumulator = 0;
+    unsigned int _count = 0;
+};
+
+uint64_t extractBits(const uint64_t *bits, const unsigned int index, const unsigned int count) {
+    const unsigned int shift = index & 63;
+    uint64_t value = bits[index >> 6] >> shift;
+    if (shift + count > 64) {
+        value |= bits[(index >> 6) + 1] << (64 - shift);
+    }
+    return count == 64 ? value : value & ((uint64_t{1} << count) - 1);
+}
+
+void expandGeneric(const uint64_t *bits, const unsigned int cells, const ScanlinePattern &pattern, const unsigned int offset, uint64_t *out) {
+    BitWriter writer(out);
+    writer.writeRun(false, offset);
+    for (unsigned int x = 0; x < cells; x++) {
+        const bool bit = bits[x >> 6] >> (x & 63) & 1;
+        writer.writeRun(pattern.bitFirst ? bit : pattern.constant, pattern.first);
+        writer.writeRun(pattern.bitFirst ? pattern.constant : bit, pattern.second);
+    }
+    writer.flush();
+}
+
+#ifdef SCANLINE_BMI2
+
+// Expands a group of cells at once: each cell bit is deposited at the start of its run and then
+// spread over the run length by a multiplication, as runs of different cells never overlap.
+__attribute__((target("bmi2")))
+void expandBmi2(const uint64_t *bits, const unsigned int cells, const ScanlinePattern &pattern, const unsigned int offset, uint64_t *out) {
+    const unsigned int period = pattern.first + pattern.second;
+    if (period > 64) {
+        expandGeneric(bits, cells, pattern, offset, out);
+        return;
+    }
+
+    const unsigned int group = 64 / period;
+    const unsigned int runOffset = pattern.bitFirst ? 0 : pattern.first;
+    const unsigned int runLength = pattern.bitFirst ? pattern.first : pattern.second;
+    const unsigned int constantOffset = pattern.bitFirst ? pattern.first : 0;
+    const unsigned int constantLength = pattern.bitFirst ? pattern.second : pattern.first;
+
+    uint64_t starts = 0, constant = 0;
+    for (unsigned int j = 0; j < group; j++) {
+        starts |= uint64_t{1} << (j * period + runOffset);
+        if (pattern.constant) {
+            constant |= ((uint64_t{1} << constantLength) - 1) << (j * period + constantOffset);
+        }
+    }
+    const uint64_t spread = (uint64_t{1} << runLength) - 1;
+
+    BitWriter writer(out);
+    writer.writeRun(false, offset);
+
+    unsigned int x = 0;
+    for (; x + group <= cells; x += group) {
+        writer.write(constant | _pdep_u64(extractBits(bits, x, group), starts) * spread, group * period);
+    }
+    if (const unsigned int remaining = cells - x; remaining != 0) {
+        const unsigned int length = remaining * period;
+        const uint64_t mask = length == 64 ? ~uint64_t{0} : (uint64_t{1} << length) - 1;
+        writer.write((constant | _pdep_u64(extractBits(bits, x, remaining), starts) * spread) & mask, length);
+    }
+    writer.flush();
+}
+
+#endif
+
+struct Kernel {
+    ScanlineKernel function;
+    const char *name;
+};
+
+Kernel selectKernel() {
+#ifdef SCANLINE_BMI2
+    if (__builtin_cpu_supports("bmi2")) {
+        return {expandBmi2, "bmi2"};
+    }
+#endif
+    return {expandGeneric, "generic"};
+}
+
+const Kernel& kernel() {
+    static const Kernel selected = selectKernel();
+    return selected;
+}
+
+ScanlineBuilder::ScanlineBuilder(const unsigned int width, const int pathSize, const int wallSize) :
+    _width(width), _pathSize(pathSize), _wallSize(wallSize),
+    _pixelWidth(pixelSize(width, pathSize, wallSize)),
+    _buffer(_pixelWidth / 64 + 2) {}
+
+uint64_t ScanlineBuilder::pixelWidth() const {
+    return _pixelWidth;
+}
+
+size_t ScanlineBuilder::lineSize() const {
+    return (_pixelWidth + 7) / 8;
+}
+
+void ScanlineBuilder::buildPathLine(const uint64_t *right, uint8_t *line) {
+    build(right, {static_cast<unsigned int>(_pathSize), static_cast<unsigned int>(_wallSize), false, true}, line);
+}
+
+void ScanlineBuilder::buildWallLine(const uint64_t *down, uint8_t *line) {
+    build(down, {static_cast<unsigned int>(_pathSize), static_cast<unsigned int>(_wallSize), true, false}, line);
+}
+
+const char* ScanlineBuilder::kernelName() {
+    return kernel().name;
+}
+
+void ScanlineBuilder::build(const uint64_t *bits, const ScanlinePattern &pattern, uint8_t *line) {
+    std::ranges::fill(_buffer, 0);
+    kernel().function(bits, _width, pattern, _wallSize, _buffer.data());
+
+    const size_t size = lineSize();
+    for (size_t i = 0; i < size; i++) {
+        line[i] = REVERSED_BYTES[_buffer[i >> 3] >> ((i & 7) << 3) & 0xFF];
+    }
+}
@@ -0,0 +1,107 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef SCANLINE_HPP
+#define SCANLINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A scanline is a repetition of one pattern per cell: a first run of pixels followed by a second run.
+// One of the two runs takes the value of the cell bit (connected or not), the other one is constant.
+struct ScanlinePattern {
+    unsigned int first, second;
+    bool bitFirst;
+    bool constant;
+};
+
+uint64_t pixelSize(uint64_t cells, int pathSize, int wallSize);
+
+class ScanlineBlock;
+
+// Receives the scanlines of an image from top to bottom.
+class ScanlineSink {
+    public:
+
+    virtual ~ScanlineSink() = default;
+
+    virtual void writeLines(const uint8_t *line, int count) = 0;
+
+    virtual void writeBlocks(const std::vector<ScanlineBlock> &blocks, size_t count);
+};
+
+// A band of scanlines kept in memory, each distinct line stored once with its repetition count.
+class ScanlineBlock : public ScanlineSink {
+    public:
+
+    explicit ScanlineBlock(size_t lineSize = 0);
+
+    void writeLines(const uint8_t *line, int count) override;
+
+    void clear();
+
+    [[nodiscard]] size_t lineSize() const;
+
+    [[nodiscard]] size_t lineCount() const;
+
+    [[nodiscard]] const uint8_t* line(size_t index) const;
+
+    [[nodiscard]] int repetitions(size_t index) const;
+
+    private:
+
+    size_t _lineSize;
+    std::vector<uint8_t> _lines{};
+    std::vector<int> _repetitions{};
+};
+
+typedef void (*ScanlineKernel)(const uint64_t *bits, unsigned int cells, const ScanlinePattern &pattern, unsigned int offset, uint64_t *out);
+
+// Builds the scanlines of one row of cells in the 1-bit, most significant bit first layout
+// used by both QImage::Format_Mono and PNG. Black is 0 and white is 1.
+class ScanlineBuilder {
+    public:
+
+    ScanlineBuilder(unsigned int width, int pathSize, int wallSize);
+
+    [[nodiscard]] uint64_t pixelWidth() const;
+
+    [[nodiscard]] size_t lineSize() const;
+
+    void buildPathLine(const uint64_t *right, uint8_t *line);
+
+    void buildWallLine(const uint64_t *down, uint8_t *line);
+
+    static const char* kernelName();
+
+    private:
+
+    void build(const uint64_t *bits, const ScanlinePattern &pattern, uint8_t *line);
+
+    unsigned int _width;
+    int _pathSize, _wallSize;
+    uint64_t _pixelWidth;
+    std::vector<uint64_t> _buffer;
+};
+
+#endif //SCANLINE_HPP
@@ -0,0 +1,161 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "streaming_maze.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+constexpr uint32_t NO_LABEL = UINT32_MAX;
+
+StreamingMaze::StreamingMaze(const unsigned int width, const unsigned int height) : _progress(std::make_shared<Progress>()), _width(width), _height(height), _stride((width + 63) / 64) {}
+
+template <typename Generator>
+void StreamingMaze::generate(Generator &generator, const double errorFactor, const RowConsumer &consumer) {
+    if (errorFactor < 0 || errorFactor > 1) {
+        throw std::range_error("Error factor must be between 0 and 1");
+    }
+
+    _progress->start(STREAMING_ROWS, _height);
+
+    _sets.resize(_width);
+    for (unsigned int x = 0; x < _width; x++) {
+        _sets[x] = x;
+    }
+    _roots.resize(_width);
+    _lastColumns.resize(_width);
+    _labels.resize(_width);
+    _connected.resize(_width);
+    _set.resize(_width);
+
+    _right.resize(_stride);
+    _down.resize(_stride);
+
+    for (unsigned int y = 0; y < _height && !_progress->isCancelled(); y++) {
+        const bool last = y == _height - 1;
+
+        std::ranges::fill(_right, 0);
+        std::ranges::fill(_down, 0);
+
+        connectRow(generator, last);
+        if (!last) {
+            nextRow();
+        }
+        if (errorFactor != 0) {
+            connectErrors(generator, errorFactor, last);
+        }
+
+        consumer(y, _right.data(), _down.data());
+        _progress->add(1);
+    }
+}
+
+template <typename Generator>
+void StreamingMaze::connectRow(Generator &generator, const bool last) {
+    RandomCoin join(generator);
+
+    for (unsigned int x = 0; x < _width; x++) {
+        _set.makeSet(_sets[x]);
+    }
+
+    // Join adjacent cells of different sets, always on the last row so that every set ends up connected.
+    for (unsigned int x = 0; x + 1 < _width; x++) {
+        if ((last || join()) && _set.unite(_sets[x], _sets[x + 1])) {
+            _right[x >> 6] |= uint64_t{1} << (x & 63);
+        }
+    }
+
+    if (last) {
+        return;
+    }
+
+    for (unsigned int x = 0; x < _width; x++) {
+        const unsigned int root = _set.find(_sets[x]);
+        _roots[x] = root;
+        _lastColumns[root] = x;
+        _connected[root] = false;
+    }
+
+    // Each set continues to the next row through at least one of its cells.
+    for (unsigned int x = 0; x < _width; x++) {
+        const unsigned int root = _roots[x];
+        if (join() || (!_connected[root] && _lastColumns[root] == x)) {
+            _down[x >> 6] |= uint64_t{1} << (x & 63);
+            _connected[root] = true;
+        }
+    }
+}
+
+// Extra connections are added on top of the walls left closed by the algorithm without changing the sets,
+// so the connections chosen above still form a spanning tree and each error opens exactly one loop.
+template <typename Generator>
+void StreamingMaze::connectErrors(Generator &generator, const double errorFactor, const bool last) {
+    RandomChance error(generator, errorFactor);
+
+    for (unsigned int x = 0; x + 1 < _width; x++) {
+        if (const uint64_t bit = uint64_t{1} << (x & 63); !(_right[x >> 6] & bit) && error()) {
+            _right[x >> 6] |= bit;
+        }
+    }
+
+    if (last) {
+        return;
+    }
+
+    for (unsigned int x = 0; x < _width; x++) {
+        if (const uint64_t bit = uint64_t{1} << (x & 63); !(_down[x >> 6] & bit) && error()) {
+            _down[x >> 6] |= bit;
+        }
+    }
+}
+
+void StreamingMaze::nextRow() {
+    std::ranges::fill(_labels, NO_LABEL);
+
+    // Cells connected from above keep the set of their parent, others start a new one.
+    // Labels are renumbered in [0, width) so that the state never grows.
+    uint32_t nextLabel = 0;
+    for (unsigned int x = 0; x < _width; x++) {
+        if (_down[x >> 6] >> (x & 63) & 1) {
+            uint32_t &label = _labels[_roots[x]];
+            if (label == NO_LABEL) {
+                label = nextLabel++;
+            }
+            _sets[x] = label;
+        } else {
+            _sets[x] = NO_LABEL;
+        }
+    }
+    for (unsigned int x = 0; x < _width; x++) {
+        if (_sets[x] == NO_LABEL) {
+            _sets[x] = nextLabel++;
+        }
+    }
+}
+
+template void StreamingMaze::generate(std::mt19937 &generator, double errorFactor, const RowConsumer &consumer);
+template void StreamingMaze::generate(Xoshiro256 &generator, double errorFactor, const RowConsumer &consumer);
+template void StreamingMaze::generate(Pcg64 &generator, double errorFactor, const RowConsumer &consumer);
+template void StreamingMaze::generate(SplitMix64 &generator, double errorFactor, const RowConsumer &consumer);
+template void StreamingMaze::generate(LoopSampling<Xoshiro256> &generator, double errorFactor, const RowConsumer &consumer);
+template void StreamingMaze::generate(LoopSampling<Pcg64> &generator, double errorFactor, const RowConsumer &consumer);
+template void StreamingMaze::generate(LoopSampling<SplitMix64> &generator, double errorFactor, const RowConsumer &consumer);
@@ -0,0 +1,67 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef STREAMING_MAZE_HPP
+#define STREAMING_MAZE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "disjoint_set.hpp"
+#include "progress.hpp"
+#include "random.hpp"
+
+typedef std::function<void(unsigned int y, const uint64_t *right, const uint64_t *down)> RowConsumer;
+
+// Generates a perfect maze one row at a time using Eller's algorithm.
+// Only the state of the current row is kept, so memory use grows with the width but not with the height.
+class StreamingMaze {
+    public:
+
+    StreamingMaze(unsigned int width, unsigned int height);
+
+    template <typename Generator>
+    void generate(Generator &generator, double errorFactor, const RowConsumer &consumer);
+
+    std::shared_ptr<Progress> _progress;
+
+    private:
+
+    template <typename Generator>
+    void connectRow(Generator &generator, bool last);
+
+    template <typename Generator>
+    void connectErrors(Generator &generator, double errorFactor, bool last);
+
+    void nextRow();
+
+    unsigned int _width, _height, _stride;
+
+    std::vector<uint32_t> _sets{}, _roots{}, _lastColumns{}, _labels{};
+    std::vector<uint8_t> _connected{};
+    DisjointSet _set{};
+
+    std::vector<uint64_t> _right{}, _down{};
+};
+
+#endif //STREAMING_MAZE_HPP
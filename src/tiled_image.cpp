@@ -0,0 +1,191 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "tiled_image.hpp"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "maze_file.hpp"
+#include "parallel.hpp"
+#include "png_writer.hpp"
+#include "renderer.hpp"
+
+namespace {
+
+// Keeps the part of the scanlines of a range of cells that belongs to a tile: the first lines and pixels belong to the
+// tiles above and on the left, the ones past the size of the tile to the next tiles.
+class TileSink : public ScanlineSink {
+    public:
+
+    TileSink(ScanlineSink &sink, const uint64_t lineWidth, const uint64_t skippedPixels, const uint64_t width, const int skippedLines, const uint64_t height) :
+        _sink(sink), _lineSize((lineWidth + 7) / 8), _skippedBytes(skippedPixels / 8), _shift(skippedPixels % 8),
+        _width(width), _skippedLines(skippedLines), _lines(height), _line((width + 7) / 8) {}
+
+    void writeLines(const uint8_t *line, int count) override {
+        const int skipped = std::min(count, _skippedLines);
+        _skippedLines -= skipped;
+        count = static_cast<int>(std::min<uint64_t>(count - skipped, _lines));
+        if (count == 0) {
+            return;
+        }
+        _lines -= count;
+
+        for (size_t i = 0; i < _line.size(); i++) {
+            const size_t source = i + _skippedBytes;
+            uint8_t byte = line[source] << _shift;
+            if (_shift != 0 && source + 1 < _lineSize) {
+                byte |= line[source + 1] >> (8 - _shift);
+            }
+            _line[i] = byte;
+        }
+        if (_width % 8 != 0) {
+            _line.back() &= 0xFF << (8 - _width % 8);
+        }
+
+        _sink.writeLines(_line.data(), count);
+    }
+
+    private:
+
+    ScanlineSink &_sink;
+    const size_t _lineSize, _skippedBytes;
+    const unsigned int _shift;
+    const uint64_t _width;
+    int _skippedLines;
+    uint64_t _lines;
+    std::vector<uint8_t> _line;
+};
+
+}
+
+bool isTiledImageFile(const QString &fileName) {
+    return fileName.endsWith(".json", Qt::CaseInsensitive);
+}
+
+QString tiledImageFileName(const QString &fileName) {
+    if (isTiledImageFile(fileName)) {
+        return fileName;
+    }
+    const QFileInfo info(fileName);
+    return info.path() + "/" + info.completeBaseName() + ".json";
+}
+
+bool exceedsPngSize(const unsigned int width, const unsigned int height, const int pathSize, const int wallSize) {
+    return pixelSize(width, pathSize, wallSize) > PNG_MAX_DIMENSION || pixelSize(height, pathSize, wallSize) > PNG_MAX_DIMENSION;
+}
+
+TiledImage::TiledImage(const Maze &maze, const int pathSize, const int wallSize, const uint64_t tileSize) :
+    _maze(maze), _pathSize(pathSize), _wallSize(wallSize),
+    _tileCells(static_cast<unsigned int>(std::max<uint64_t>(tileSize / (pathSize + wallSize), 1))),
+    _columns((maze.width() + _tileCells - 1) / _tileCells), _rows((maze.height() + _tileCells - 1) / _tileCells) {}
+
+unsigned int TiledImage::columns() const {
+    return _columns;
+}
+
+unsigned int TiledImage::rows() const {
+    return _rows;
+}
+
+bool TiledImage::write(const QString &fileName, const int compressionLevel, const int threads, Progress &progress) const {
+    const QString directory = fileName.left(fileName.size() - 5) + "_tiles";
+    if (!QDir().mkpath(directory)) {
+        return false;
+    }
+
+    const unsigned int tiles = _columns * _rows;
+    std::atomic<bool> failed{false};
+    progress.start(TILING, tiles);
+
+    parallelFor(tiles, threads, [&](const unsigned int tile) {
+        if (progress.isCancelled() || failed.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const unsigned int column = tile % _columns, row = tile / _columns;
+        if (!writeTile(QString("%1/%2_%3.png").arg(directory).arg(column).arg(row), column, row, compressionLevel)) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+
+        progress.add(1);
+    });
+
+    if (failed.load(std::memory_order_relaxed) || progress.isCancelled()) {
+        return false;
+    }
+
+    // Tile (column, row) starts at pixel (column * tileSize, row * tileSize). The last tiles of each axis also hold the border.
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QString(R"({
+    "width": %1,
+    "height": %2,
+    "tileSize": %3,
+    "columns": %4,
+    "rows": %5,
+    "tiles": "%6/{column}_{row}.png"
+}
+)").arg(pixelSize(_maze.width(), _pathSize, _wallSize)).arg(pixelSize(_maze.height(), _pathSize, _wallSize))
+        .arg(static_cast<uint64_t>(_tileCells) * (_pathSize + _wallSize)).arg(_columns).arg(_rows)
+        .arg(QFileInfo(directory).fileName()).toUtf8());
+    return file.commit();
+}
+
+// The cells before the tile are rendered too, for their right and down walls, and then cropped.
+bool TiledImage::writeTile(const QString &fileName, const unsigned int column, const unsigned int row, const int compressionLevel) const {
+    const unsigned int width = _maze.width(), height = _maze.height();
+    const unsigned int left = column * _tileCells, right = std::min(left + _tileCells, width);
+    const unsigned int top = row * _tileCells, bottom = std::min(top + _tileCells, height);
+    const unsigned int first = left == 0 ? 0 : left - 1, cells = right - first;
+
+    const uint64_t period = _pathSize + _wallSize;
+    const uint64_t tileWidth = (right - left) * period + (right == width ? _wallSize : 0);
+    const uint64_t tileHeight = (bottom - top) * period + (bottom == height ? _wallSize : 0);
+
+    PngWriter writer(fileName, compressionLevel);
+    if (!writer.open(tileWidth, tileHeight)) {
+        return false;
+    }
+
+    TileSink sink(writer, pixelSize(cells, _pathSize, _wallSize), left == 0 ? 0 : period, tileWidth, top == 0 ? 0 : _pathSize, tileHeight);
+    Renderer renderer(cells, _pathSize, _wallSize, sink);
+    if (top == 0) {
+        renderer.renderTop();
+    }
+
+    std::vector<uint64_t> rightBits((cells + 63) / 64), downBits((cells + 63) / 64);
+    for (unsigned int y = top == 0 ? 0 : top - 1; y < bottom; y++) {
+        std::ranges::fill(rightBits, 0);
+        std::ranges::fill(downBits, 0);
+        copyBits(_maze.rightRow(y), first, rightBits.data(), 0, cells);
+        copyBits(_maze.downRow(y), first, downBits.data(), 0, cells);
+        renderer.renderRow(rightBits.data(), downBits.data());
+    }
+    return writer.finish();
+}
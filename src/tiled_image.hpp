@@ -0,0 +1,66 @@
+/*
+* Copyright (c) 2026 Hugo Dupanloup (Yeregorix)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef TILED_IMAGE_HPP
+#define TILED_IMAGE_HPP
+
+#include <QString>
+#include <cstdint>
+#include "maze.hpp"
+
+// Most image viewers and GPU textures still accept images of this size.
+constexpr uint64_t TILED_IMAGE_TILE_SIZE = 16384;
+
+bool isTiledImageFile(const QString &fileName);
+
+// The manifest written instead of an image file, the image file itself when it already names one.
+QString tiledImageFileName(const QString &fileName);
+
+// Whether the image of a maze has more pixels per side than a single PNG can hold.
+bool exceedsPngSize(unsigned int width, unsigned int height, int pathSize, int wallSize);
+
+// Splits the image of a maze in a grid of PNG files described by a JSON manifest, for images beyond the limits of a single PNG.
+// Tiles are cut at cell boundaries and start with the walls of the previous cells, so each one is rendered from its own
+// rows and columns of cells: a thread only keeps the scanlines of the tile it writes, whatever the size of the image.
+class TiledImage {
+    public:
+
+    TiledImage(const Maze &maze, int pathSize, int wallSize, uint64_t tileSize = TILED_IMAGE_TILE_SIZE);
+
+    [[nodiscard]] unsigned int columns() const;
+
+    [[nodiscard]] unsigned int rows() const;
+
+    // Writes the tiles to a directory named after the manifest, then the manifest with the size of the image and of the tiles.
+    bool write(const QString &fileName, int compressionLevel, int threads, Progress &progress) const;
+
+    private:
+
+    [[nodiscard]] bool writeTile(const QString &fileName, unsigned int column, unsigned int row, int compressionLevel) const;
+
+    const Maze &_maze;
+    const int _pathSize, _wallSize;
+    const unsigned int _tileCells;
+    const unsigned int _columns, _rows;
+};
+
+#endif //TILED_IMAGE_HPP
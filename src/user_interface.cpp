@@ -28,8 +28,10 @@
 #include <QFileDialog>
 #include <QProgressDialog>
 #include <QThreadPool>
+#include <QTimer>
 #include <random>
 
+#include "maze_preview.hpp"
 #include "worker.hpp"
 
 UserInterface::UserInterface(QWidget *parent) : QWidget(parent) {
@@ -39,17 +41,21 @@ UserInterface::UserInterface(QWidget *parent) : QWidget(parent) {
     _width = new QSpinBox(), _height = new QSpinBox();
     _error = new QDoubleSpinBox();
     _pathSize = new QSpinBox(), _wallSize = new QSpinBox();
+    _engine = new QComboBox();
+    _threads = new QSpinBox();
+    _compressionLevel = new QSpinBox();
+    _randomAlgorithm = new QComboBox();
 
     _seed->setMinimum(INT_MIN);
     _seed->setMaximum(INT_MAX);
     _seed->setValue(0);
 
     _width->setMinimum(1);
-    _width->setMaximum(10000);
+    _width->setMaximum(INT_MAX);
     _width->setValue(30);
 
     _height->setMinimum(1);
-    _height->setMaximum(10000);
+    _height->setMaximum(INT_MAX);
     _height->setValue(30);
 
     _error->setMinimum(0);
@@ -65,11 +71,35 @@ UserInterface::UserInterface(QWidget *parent) : QWidget(parent) {
     _wallSize->setMaximum(100);
     _wallSize->setValue(1);
 
+    _engine->addItem("Classic", CLASSIC);
+    _engine->addItem("Tiled", TILED);
+    _engine->addItem("Streaming", STREAMING);
+    _engine->addItem("Wilson", WILSON);
+    _engine->addItem("Prim", PRIM);
+    _engine->addItem("Backtracker", BACKTRACKER);
+    _engine->addItem("Sidewinder", SIDEWINDER);
+    _engine->addItem("Binary tree", BINARY_TREE);
+
+    _threads->setMinimum(0);
+    _threads->setMaximum(256);
+    _threads->setValue(0);
+    _threads->setSpecialValueText("Auto");
+
+    _compressionLevel->setMinimum(0);
+    _compressionLevel->setMaximum(9);
+    _compressionLevel->setValue(6);
+
+    for (const RandomAlgorithm algorithm : RANDOM_ALGORITHMS) {
+        _randomAlgorithm->addItem(randomAlgorithmName(algorithm), algorithm);
+    }
+
     auto *randomSeedButton = new QPushButton("Random");
     auto *generateButton = new QPushButton("Generate");
+    auto *previewButton = new QPushButton("Preview");
 
     connect(randomSeedButton, &QPushButton::clicked, this, &UserInterface::randomSeed);
     connect(generateButton, &QPushButton::clicked, this, &UserInterface::generate);
+    connect(previewButton, &QPushButton::clicked, this, &UserInterface::preview);
 
     auto *layout = new QGridLayout(this);
 
@@ -88,14 +118,25 @@ UserInterface::UserInterface(QWidget *parent) : QWidget(parent) {
     layout->addWidget(_pathSize, 3, 1);
     layout->addWidget(_wallSize, 3, 2);
 
-    layout->addWidget(generateButton, 4, 0, 1, 3);
+    layout->addWidget(new QLabel("Engine:"), 4, 0);
+    layout->addWidget(_engine, 4, 1);
+    layout->addWidget(_threads, 4, 2);
+
+    layout->addWidget(new QLabel("Compression:"), 5, 0);
+    layout->addWidget(_compressionLevel, 5, 1);
+
+    layout->addWidget(new QLabel("Random:"), 6, 0);
+    layout->addWidget(_randomAlgorithm, 6, 1);
+
+    layout->addWidget(generateButton, 7, 0, 1, 2);
+    layout->addWidget(previewButton, 7, 2);
 
     layout->setColumnStretch(0, 10);
     layout->setColumnStretch(1, 45);
     layout->setColumnStretch(2, 45);
 
     _fileDialog.setAcceptMode(QFileDialog::AcceptSave);
-    _fileDialog.setNameFilter("Image (*.png)");
+    _fileDialog.setNameFilters({"Image (*.png)", "Deep Zoom image (*.dzi)", "Tiled image (*.json)"});
     _fileDialog.setDirectory(QDir::homePath());
 }
 
@@ -110,32 +151,66 @@ void UserInterface::generate() {
         const QString fileName = _fileDialog.selectedFiles().first();
         _fileDialog.setDirectory(QFileInfo(fileName).path());
 
-        const WorkerParameters parameters = {
-            _seed->value(),
-            _width->value(), _height->value(),
-            _error->value(),
-            _pathSize->value(), _wallSize->value(),
-            fileName
-        };
-
-        auto *dialog = new QProgressDialog();
-        dialog->setWindowModality(Qt::WindowModal);
-        dialog->setWindowTitle("Generating maze ...");
-        dialog->setFixedWidth(300);
-        dialog->setRange(0, WORKER_MAX_PROGRESS);
-        dialog->setAutoClose(false);
-        dialog->setAutoReset(false);
-
-        auto *worker = new Worker(parameters);
-
-        connect(worker, &Worker::message, dialog, &QProgressDialog::setLabelText);
-        connect(worker, &Worker::progress, dialog, &QProgressDialog::setValue);
-        connect(worker, &Worker::finished, dialog, &QProgressDialog::close);
-
-        connect(dialog, &QProgressDialog::canceled, worker, &Worker::cancel);
-        connect(dialog, &QProgressDialog::finished, dialog, &QProgressDialog::deleteLater);
-
-        QThreadPool::globalInstance()->start(worker);
-        dialog->open();
+        const auto progress = std::make_shared<Progress>();
+        start(new Worker(parameters(fileName), progress), progress);
     }
 }
+
+// The maze is kept in memory and shown in a new window instead of being written.
+void UserInterface::preview() {
+    const WorkerParameters previewParameters = parameters(QString());
+    const auto progress = std::make_shared<Progress>();
+    auto *worker = new Worker(previewParameters, progress);
+
+    connect(worker, &Worker::generated, this, [previewParameters](std::shared_ptr<const Maze> maze) {
+        auto *preview = new MazePreview(std::move(maze), previewParameters.pathSize, previewParameters.wallSize);
+        preview->setAttribute(Qt::WA_DeleteOnClose);
+        preview->show();
+    });
+
+    start(worker, progress);
+}
+
+WorkerParameters UserInterface::parameters(const QString &fileName) const {
+    return {
+        _seed->value(),
+        _width->value(), _height->value(),
+        _error->value(),
+        _pathSize->value(), _wallSize->value(),
+        fileName,
+        static_cast<Engine>(_engine->currentData().toInt()),
+        _threads->value(),
+        _compressionLevel->value(),
+        static_cast<RandomAlgorithm>(_randomAlgorithm->currentData().toInt())
+    };
+}
+
+void UserInterface::start(Worker *worker, const std::shared_ptr<Progress> &progress) {
+    auto *dialog = new QProgressDialog();
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setWindowTitle("Generating maze ...");
+    dialog->setFixedWidth(300);
+    dialog->setRange(0, PROGRESS_MAX);
+    dialog->setAutoClose(false);
+    dialog->setAutoReset(false);
+
+    // The worker only updates shared counters, the dialog polls them.
+    auto *timer = new QTimer(dialog);
+    connect(timer, &QTimer::timeout, dialog, [dialog, progress] {
+        dialog->setLabelText(stageName(progress->stage()));
+        dialog->setValue(progress->value());
+    });
+
+    connect(worker, &Worker::message, dialog, &QProgressDialog::setLabelText);
+    connect(worker, &Worker::finished, timer, &QTimer::stop);
+    connect(worker, &Worker::finished, dialog, &QProgressDialog::close);
+
+    connect(dialog, &QProgressDialog::canceled, dialog, [progress] {
+        progress->cancel();
+    });
+    connect(dialog, &QProgressDialog::finished, dialog, &QProgressDialog::deleteLater);
+
+    QThreadPool::globalInstance()->start(worker);
+    timer->start(50);
+    dialog->open();
+}
@@ -23,9 +23,11 @@
 #ifndef USER_INTERFACE_HPP
 #define USER_INTERFACE_HPP
 
+#include <QComboBox>
 #include <QFileDialog>
 #include <QSpinBox>
 #include <QWidget>
+#include "worker.hpp"
 
 class UserInterface : public QWidget {
     Q_OBJECT
@@ -39,12 +41,22 @@ class UserInterface : public QWidget {
 
     void generate();
 
+    void preview();
+
     private:
 
+    [[nodiscard]] WorkerParameters parameters(const QString &fileName) const;
+
+    void start(Worker *worker, const std::shared_ptr<Progress> &progress);
+
     QSpinBox *_seed;
     QSpinBox *_width, *_height;
     QDoubleSpinBox *_error;
     QSpinBox *_pathSize, *_wallSize;
+    QComboBox *_engine;
+    QSpinBox *_threads;
+    QSpinBox *_compressionLevel;
+    QComboBox *_randomAlgorithm;
 
     QFileDialog _fileDialog;
 };
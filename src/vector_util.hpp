@@ -25,12 +25,12 @@
 #include <vector>
 
 template <typename T>
-std::vector<T*> toPointers(std::vector<T>& values) {
-    std::vector<T*> pointers(values.size());
-    for (size_t i = 0; i < values.size(); i++) {
-        pointers[i] = &(values[i]);
+std::vector<T> sequence(const T size) {
+    std::vector<T> values(size);
+    for (T i = 0; i < size; i++) {
+        values[i] = i;
     }
-    return pointers;
+    return values;
 }
 
 #endif //VECTOR_UTIL_HPP
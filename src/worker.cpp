@@ -22,66 +22,257 @@
 
 #include "worker.hpp"
 
+#include <exception>
 #include <iostream>
 
 #include "chrono.hpp"
+#include "deep_zoom.hpp"
 #include "maze.hpp"
+#include "maze_cache.hpp"
+#include "maze_file.hpp"
+#include "png_writer.hpp"
+#include "renderer.hpp"
+#include "streaming_maze.hpp"
+#include "tiled_image.hpp"
 
-Worker::Worker(const WorkerParameters &parameters) : _parameters(parameters) {
+Worker::Worker(const WorkerParameters &parameters, std::shared_ptr<Progress> progress) : _parameters(parameters), _progress(std::move(progress)) {
     setAutoDelete(true);
 }
 
 void Worker::run() {
-    const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName] = _parameters;
+    const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _parameters;
+
+    std::cout << "Generating maze ... (" << width << "x" << height << ", error:" << errorFactor << ", seed:" << seed << ", engine:" << engineName(engine) << ", random:" << randomAlgorithmName(randomAlgorithm) << ")" << std::endl;
+
+    // Allocations fail with an exception, for example when the storage directory is not usable or the maze does not fit.
+    bool failed = false;
+    try {
+        dispatch();
+    } catch (const std::exception &error) {
+        std::cout << "Error: " << error.what() << std::endl;
+        _succeeded = false;
+        failed = true;
+    }
+
+    const auto taskResult = isCancelled() ? "Task cancelled." : failed ? "Task failed." : "Task completed.";
+    std::cout << taskResult << std::endl;
+    emit message(taskResult);
+
+    emit finished();
+}
+
+void Worker::dispatch() {
+    const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _parameters;
+
+    // A cached image is only enough when the maze file is not requested.
+    if (_cache != nullptr && mazeFileName.isEmpty() && !fileName.isEmpty() && !isDeepZoomFile(fileName) && !isTiledImageFile(fileName) && _cache->fetch(MazeCache::imageKey(_parameters), fileName)) {
+        std::cout << "Image found in cache." << std::endl;
+        _succeeded = true;
+    } else if (!canConnect(engine, randomAlgorithm, errorFactor, static_cast<uint64_t>(width) * height)) {
+        std::cout << "Mazes of more than " << MAZE_MAX_INDEXED_CELLS << " cells need the tiled, sidewinder or binary-tree engine, and a v2 random algorithm for loops." << std::endl;
+    } else if (engine == STREAMING && (fileName.isEmpty() || isDeepZoomFile(fileName) || isTiledImageFile(fileName))) {
+        std::cout << "The streaming engine keeps no maze to preview or to tile." << std::endl;
+    } else if (fileName.isEmpty()) {
+        if (std::shared_ptr<const Maze> maze = generateMaze(); maze != nullptr) {
+            _succeeded = true;
+            emit generated(std::move(maze));
+        }
+    } else if (engine == STREAMING) {
+        generateStreaming();
+    } else {
+        generate();
+    }
+}
+
+void Worker::generate() {
+    const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _parameters;
+
+    const std::unique_ptr<Maze> maze = generateMaze();
+    if (maze == nullptr) {
+        return;
+    }
+
+    if (!mazeFileName.isEmpty()) {
+        std::cout << "Saving maze ... (" << mazeFileName.toStdString() << ")" << std::endl;
+        const bool saveResult = maze->save(mazeFileName, mazeFileInfo(), compressionLevel, threads);
+        std::cout << "Save " << (saveResult ? "succeeded" : "failed") << "." << std::endl;
+    }
+
+    if (isDeepZoomFile(fileName)) {
+        writeDeepZoom(*maze);
+        return;
+    }
+
+    if (isTiledImageFile(fileName) || exceedsPngSize(width, height, pathSize, wallSize)) {
+        writeTiledImage(*maze);
+        return;
+    }
+
+    writeImage([&](ScanlineSink &sink) {
+        maze->generateImage(pathSize, wallSize, sink, threads);
+    });
+}
+
+std::unique_ptr<Maze> Worker::generateMaze() {
+    const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _parameters;
+
+    const QString key = _cache != nullptr ? MazeCache::mazeKey(_parameters) : QString();
+    if (_cache != nullptr && _cache->find(key)) {
+        MazeFileInfo info;
+        if (std::unique_ptr<Maze> maze = Maze::load(_cache->path(key), info, threads); maze != nullptr) {
+            std::cout << "Maze found in cache." << std::endl;
+            maze->_progress = _progress;
+            return maze;
+        }
+    }
 
-    std::cout << "Generating maze ... (" << width << "x" << height << ", error:" << errorFactor << ", seed:" << seed << ")" << std::endl;
     Chrono chrono;
 
-    emit message("Initializing ...");
-    std::mt19937 generator(seed);
-    Maze maze(width, height);
-    maze._worker = this;
+    auto maze = std::make_unique<Maze>(width, height);
+    maze->_progress = _progress;
 
-    emit message("Filling points ...");
-    maze.fill();
+    maze->fill();
 
-    emit message("Connecting points ...");
-    maze.connectAll(generator, errorFactor);
+    withGenerator(randomAlgorithm, seed, [&](auto &generator) {
+        maze->connect(engine, generator, errorFactor, threads);
+    });
 
     chrono.done();
 
-    if (!_cancelled) {
-        std::cout << "Generating image ... (" << pathSize << ":" << wallSize << ")" << std::endl;
-        chrono.restart();
+    if (const auto &[finds, steps, maxDepth] = maze->connectStatistics(); finds != 0) {
+        std::cout << "Find depth: " << steps / static_cast<double>(finds) << " average, " << maxDepth << " max (" << finds << " finds)" << std::endl;
+    }
+
+    if (isCancelled()) {
+        return nullptr;
+    }
+
+    if (_cache != nullptr && maze->save(_cache->path(key), mazeFileInfo(), compressionLevel, threads)) {
+        _cache->evict();
+    }
+    return maze;
+}
+
+void Worker::generateStreaming() {
+    const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _parameters;
 
-        emit message("Generating image ...");
-        const QBitmap image = maze.generateImage(pathSize, wallSize);
+    // The maze file is written alongside the image, from the same rows.
+    std::unique_ptr<MazeFileWriter> mazeWriter;
+    if (!mazeFileName.isEmpty()) {
+        std::cout << "Saving maze ... (" << mazeFileName.toStdString() << ")" << std::endl;
+        mazeWriter = std::make_unique<MazeFileWriter>(mazeFileName, compressionLevel, threads);
+        if (!mazeWriter->open(mazeFileInfo())) {
+            mazeWriter.reset();
+            std::cout << "Save failed." << std::endl;
+        }
+    }
 
-        chrono.done();
+    writeImage([&](ScanlineSink &sink) {
+        StreamingMaze maze(width, height);
+        maze._progress = _progress;
 
-        if (!_cancelled) {
-            std::cout << "Writing to file ... (" << fileName.toStdString() << ")" << std::endl;
-            chrono.restart();
+        Renderer renderer(width, pathSize, wallSize, sink);
+        renderer.renderTop();
+        withGenerator(randomAlgorithm, seed, [&](auto &generator) {
+            maze.generate(generator, errorFactor, [&renderer, &mazeWriter](unsigned int, const uint64_t *right, const uint64_t *down) {
+                renderer.renderRow(right, down);
+                if (mazeWriter != nullptr) {
+                    mazeWriter->addRow(right, down);
+                }
+            });
+        });
+    });
 
-            emit message("Writing image ...");
-            const bool writeResult = image.save(fileName, "PNG");
+    if (mazeWriter != nullptr) {
+        if (isCancelled()) {
+            mazeWriter->cancel();
+        } else {
+            std::cout << "Save " << (mazeWriter->finish() ? "succeeded" : "failed") << "." << std::endl;
+        }
+    }
+}
+
+// The image is encoded while it is rendered, so only a few scanlines are kept in memory.
+void Worker::writeImage(const std::function<void(ScanlineSink &sink)> &render) {
+    const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _parameters;
+
+    std::cout << "Generating image ... (" << pathSize << ":" << wallSize << ", kernel:" << ScanlineBuilder::kernelName() << ")" << std::endl;
+    std::cout << "Writing to file ... (" << fileName.toStdString() << ", compression:" << compressionLevel << ")" << std::endl;
+    if (exceedsPngSize(width, height, pathSize, wallSize)) {
+        std::cout << "The image exceeds the " << PNG_MAX_DIMENSION << " pixels per side of a PNG." << std::endl;
+        return;
+    }
+    Chrono chrono;
 
-            chrono.done();
-            std::cout << "Write " << (writeResult ? "succeeded" : "failed") << "." << std::endl;
+    PngWriter writer(fileName, compressionLevel, threads);
+    bool writeResult = writer.open(pixelSize(width, pathSize, wallSize), pixelSize(height, pathSize, wallSize));
+    if (writeResult) {
+        render(writer);
+        if (isCancelled()) {
+            writer.cancel();
+            return;
         }
+        writeResult = writer.finish();
     }
 
-    const auto taskResult = _cancelled ? "Task cancelled." : "Task completed.";
-    std::cout << taskResult << std::endl;
-    emit message(taskResult);
+    chrono.done();
+    std::cout << "Write " << (writeResult ? "succeeded" : "failed") << "." << std::endl;
+    _succeeded = writeResult;
 
-    emit finished();
+    if (writeResult && _cache != nullptr) {
+        _cache->insert(MazeCache::imageKey(_parameters), fileName);
+    }
+}
+
+void Worker::writeDeepZoom(const Maze &maze) {
+    const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _parameters;
+
+    const DeepZoom deepZoom(maze, pathSize, wallSize);
+    std::cout << "Generating tiles ... (" << pathSize << ":" << wallSize << ", levels:" << deepZoom.levelCount() << ")" << std::endl;
+    std::cout << "Writing to file ... (" << fileName.toStdString() << ", compression:" << compressionLevel << ")" << std::endl;
+    Chrono chrono;
+
+    _succeeded = deepZoom.write(fileName, compressionLevel, threads, *_progress);
+
+    chrono.done();
+    std::cout << "Write " << (_succeeded ? "succeeded" : "failed") << "." << std::endl;
+}
+
+// An image too large for a single PNG is written as tiles next to a manifest named after it.
+void Worker::writeTiledImage(const Maze &maze) {
+    const auto [seed, width, height, errorFactor, pathSize, wallSize, fileName, engine, threads, compressionLevel, randomAlgorithm, mazeFileName] = _parameters;
+
+    const QString manifestName = tiledImageFileName(fileName);
+    const TiledImage image(maze, pathSize, wallSize);
+    std::cout << "Generating tiles ... (" << pathSize << ":" << wallSize << ", tiles:" << image.columns() << "x" << image.rows() << ")" << std::endl;
+    std::cout << "Writing to file ... (" << manifestName.toStdString() << ", compression:" << compressionLevel << ")" << std::endl;
+    Chrono chrono;
+
+    _succeeded = image.write(manifestName, compressionLevel, threads, *_progress);
+
+    chrono.done();
+    std::cout << "Write " << (_succeeded ? "succeeded" : "failed") << "." << std::endl;
+}
+
+MazeFileInfo Worker::mazeFileInfo() const {
+    return {
+        static_cast<unsigned int>(_parameters.width), static_cast<unsigned int>(_parameters.height),
+        _parameters.seed, _parameters.errorFactor, _parameters.engine, _parameters.randomAlgorithm
+    };
+}
+
+void Worker::setCache(std::shared_ptr<MazeCache> cache) {
+    _cache = std::move(cache);
 }
 
 bool Worker::isCancelled() const {
-    return _cancelled;
+    return _progress->isCancelled();
+}
+
+bool Worker::hasSucceeded() const {
+    return _succeeded;
 }
 
 void Worker::cancel() {
-    _cancelled = true;
+    _progress->cancel();
 }
@@ -25,32 +25,50 @@
 
 #include <QObject>
 #include <QRunnable>
+#include <functional>
+#include <memory>
+#include "engine.hpp"
+#include "progress.hpp"
+#include "random.hpp"
 
 struct WorkerParameters {
     int seed;
     int width, height;
     double errorFactor;
     int pathSize, wallSize;
-    QString fileName;
+    QString fileName; // The maze is only generated and handed out by the generated signal when empty.
+    Engine engine = CLASSIC;
+    int threads = 0;
+    int compressionLevel = 6;
+    RandomAlgorithm randomAlgorithm = MT19937;
+    QString mazeFileName; // Also saves the walls to a maze file when not empty.
 };
 
-constexpr int WORKER_MAX_PROGRESS = 1000;
+class Maze;
+class MazeCache;
+class ScanlineSink;
+struct MazeFileInfo;
 
 class Worker : public QObject, public QRunnable {
     Q_OBJECT
     public:
 
-    explicit Worker(const WorkerParameters &parameters);
+    explicit Worker(const WorkerParameters &parameters, std::shared_ptr<Progress> progress = std::make_shared<Progress>());
 
     void run() override;
 
     bool isCancelled() const;
 
+    bool hasSucceeded() const;
+
+    // Generated mazes and images are then looked up in the cache before generating them.
+    void setCache(std::shared_ptr<MazeCache> cache);
+
     signals:
 
     void message(const QString &message);
 
-    void progress(int value);
+    void generated(std::shared_ptr<const Maze> maze);
 
     void finished();
 
@@ -60,8 +78,26 @@ class Worker : public QObject, public QRunnable {
 
     private:
 
+    void dispatch();
+
+    void generate();
+
+    std::unique_ptr<Maze> generateMaze();
+
+    void generateStreaming();
+
+    void writeImage(const std::function<void(ScanlineSink &sink)> &render);
+
+    void writeDeepZoom(const Maze &maze);
+
+    void writeTiledImage(const Maze &maze);
+
+    MazeFileInfo mazeFileInfo() const;
+
     const WorkerParameters _parameters;
-    bool _cancelled{false};
+    std::shared_ptr<Progress> _progress;
+    std::shared_ptr<MazeCache> _cache;
+    bool _succeeded{false};
 };
 
 